@@ -0,0 +1,260 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace xilefian {
+
+    /**
+     * bheap whose values are reached through handles, which stay valid while the value moves around the heap
+     * A side table maps each handle to its current slot and is updated on every move, so lookups are O(1)
+     * Slots of popped or erased values are recycled by later pushes under a new generation, so stale handles are never mistaken for live ones
+     */
+    template <typename T, class Compare = std::less<T>, std::size_t Arity = 2, class Allocator = std::allocator<T>>
+    class addressable_bheap {
+        static_assert(Arity >= 2, "A heap node needs at least two children");
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using allocator_type = Allocator;
+
+        struct handle_type {
+            size_type index;
+            size_type generation;
+
+            constexpr bool operator==(const handle_type& rhs) const noexcept = default;
+        };
+    private:
+        struct entry {
+            value_type value;
+            size_type index;
+        };
+
+        struct slot {
+            size_type position;
+            size_type generation;
+        };
+
+        using entry_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<entry>;
+        using slot_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<slot>;
+        using size_allocator = typename std::allocator_traits<Allocator>::template rebind_alloc<size_type>;
+
+        static constexpr auto npos = ~static_cast<size_type>(0);
+    public:
+        constexpr explicit addressable_bheap(const Compare& comparator = Compare(), const Allocator& allocator = Allocator()) noexcept : m_heap(entry_allocator{allocator}), m_slots(slot_allocator{allocator}), m_free(size_allocator{allocator}), m_comparator{comparator} {}
+
+        [[nodiscard]]
+        constexpr bool empty() const noexcept {
+            return m_heap.empty();
+        }
+
+        [[nodiscard]]
+        constexpr size_type size() const noexcept {
+            return m_heap.size();
+        }
+
+        constexpr const value_type& front() const noexcept {
+            return m_heap.front().value;
+        }
+
+        [[nodiscard]]
+        constexpr handle_type front_handle() const noexcept {
+            const auto index = m_heap.front().index;
+            return handle_type{index, m_slots[index].generation};
+        }
+
+        /**
+         * Modifying the value through this reference must be followed by update(handle)
+         * The accessors and modifiers taking a handle require contains(handle)
+         */
+        constexpr value_type& operator[](handle_type handle) noexcept {
+            return m_heap[m_slots[handle.index].position].value;
+        }
+
+        constexpr const value_type& operator[](handle_type handle) const noexcept {
+            return m_heap[m_slots[handle.index].position].value;
+        }
+
+        /**
+         * False once the value of handle was popped or erased, even after a later push reuses its slot
+         */
+        [[nodiscard]]
+        constexpr bool contains(handle_type handle) const noexcept {
+            return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation && m_slots[handle.index].position != npos;
+        }
+
+        template <typename... Args>
+        constexpr handle_type emplace(Args&&... args) noexcept {
+            const auto index = make_slot();
+            m_heap.push_back(entry{value_type(std::forward<Args>(args)...), index});
+            m_slots[index].position = m_heap.size() - 1;
+            sift_up(m_heap.size() - 1);
+            return handle_type{index, m_slots[index].generation};
+        }
+
+        constexpr handle_type push(const value_type& value) noexcept {
+            return emplace(value); // Calls copy constructor
+        }
+
+        constexpr handle_type push(value_type&& value) noexcept {
+            return emplace(std::move(value)); // Calls move constructor
+        }
+
+        constexpr void pop() noexcept {
+            remove_at(0);
+        }
+
+        constexpr void erase(handle_type handle) noexcept {
+            remove_at(m_slots[handle.index].position);
+        }
+
+        /**
+         * Restores heap order after the value of handle was changed in either direction
+         */
+        constexpr void update(handle_type handle) noexcept {
+            const auto pos = m_slots[handle.index].position;
+            if (sift_up(pos) == pos) {
+                sift_down(pos);
+            }
+        }
+
+        /**
+         * Replaces the value of handle with one that Compare does not order before it, moving it towards the front
+         * With Compare = std::greater (a min-heap), this is the decrease-key of Dijkstra and A*
+         */
+        constexpr void decrease(handle_type handle, const value_type& value) noexcept {
+            const auto pos = m_slots[handle.index].position;
+            m_heap[pos].value = value;
+            sift_up(pos);
+        }
+
+        constexpr void decrease(handle_type handle, value_type&& value) noexcept {
+            const auto pos = m_slots[handle.index].position;
+            m_heap[pos].value = std::move(value);
+            sift_up(pos);
+        }
+
+        constexpr void clear() noexcept {
+            for (const auto& e : m_heap) {
+                retire(e.index);
+            }
+            m_heap.clear();
+        }
+
+        constexpr void swap(addressable_bheap& other) noexcept {
+            std::swap(m_heap, other.m_heap);
+            std::swap(m_slots, other.m_slots);
+            std::swap(m_free, other.m_free);
+            std::swap(m_comparator, other.m_comparator);
+        }
+    private:
+        constexpr size_type make_slot() noexcept {
+            if (!m_free.empty()) {
+                const auto index = m_free.back();
+                m_free.pop_back();
+                return index;
+            }
+            m_slots.push_back(slot{npos, 0});
+            return m_slots.size() - 1;
+        }
+
+        constexpr void place(size_type pos, entry&& e) noexcept {
+            m_heap[pos] = std::move(e);
+            m_slots[m_heap[pos].index].position = pos;
+        }
+
+        constexpr void retire(size_type index) noexcept {
+            m_slots[index].position = npos;
+            ++m_slots[index].generation; // Invalidates every handle issued for this slot so far
+            m_free.push_back(index);
+        }
+
+        constexpr void remove_at(size_type pos) noexcept {
+            retire(m_heap[pos].index);
+
+            auto last = std::move(m_heap.back());
+            m_heap.pop_back();
+            if (pos == m_heap.size()) {
+                return;
+            }
+
+            place(pos, std::move(last));
+            if (sift_up(pos) == pos) {
+                sift_down(pos);
+            }
+        }
+
+        // Both sifts carry the value in a hole and move each displaced entry once, updating its slot in the side table
+
+        constexpr size_type sift_up(size_type pos) noexcept {
+            if (pos == 0) {
+                return pos;
+            }
+
+            auto e = std::move(m_heap[pos]);
+            while (pos != 0) {
+                const auto parent = (pos - 1) / Arity;
+                if (!m_comparator(m_heap[parent].value, e.value)) {
+                    break;
+                }
+                place(pos, std::move(m_heap[parent]));
+                pos = parent;
+            }
+            place(pos, std::move(e));
+            return pos;
+        }
+
+        constexpr void sift_down(size_type pos) noexcept {
+            const auto size = m_heap.size();
+
+            auto e = std::move(m_heap[pos]);
+            while (true) {
+                const auto first = pos * Arity + 1;
+                if (first >= size) {
+                    break;
+                }
+
+                const auto last = std::min(first + Arity, size);
+                auto largest = first;
+                for (auto child = first + 1; child < last; ++child) {
+                    largest = m_comparator(m_heap[largest].value, m_heap[child].value) ? child : largest;
+                }
+
+                if (!m_comparator(e.value, m_heap[largest].value)) {
+                    break;
+                }
+                place(pos, std::move(m_heap[largest]));
+                pos = largest;
+            }
+            place(pos, std::move(e));
+        }
+
+        std::vector<entry, entry_allocator> m_heap;
+        std::vector<slot, slot_allocator> m_slots;
+        std::vector<size_type, size_allocator> m_free;
+        Compare m_comparator;
+    };
+
+}
+
+namespace std {
+
+    template <typename T, class Compare, std::size_t Arity, class Allocator>
+    constexpr void swap(xilefian::addressable_bheap<T, Compare, Arity, Allocator>& lhs, xilefian::addressable_bheap<T, Compare, Arity, Allocator>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+}
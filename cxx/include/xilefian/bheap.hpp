@@ -10,12 +10,33 @@
 #pragma once
 
 #include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
 
 namespace xilefian {
 
-    template <typename T, class Compare = std::less<T>, class Container = std::vector<T>>
+    /**
+     * How pop restores the heap after moving the last value to the front
+     * top_down compares the value against the largest child at every level on the way down (Arity comparisons per level)
+     * bottom_up first follows the largest children to a leaf (Arity - 1 comparisons per level), then sifts the value back up,
+     * which is usually only a level or two as the last value tends to belong near the bottom
+     */
+    enum class bheap_sift {
+        top_down,
+        bottom_up
+    };
+
+    /**
+     * Max-heap (by Compare) over a random-access container, each node having Arity children
+     * Wider nodes make the heap shallower and keep siblings adjacent, pop then touches fewer cache lines
+     */
+    template <typename T, class Compare = std::less<T>, class Container = std::vector<T>, std::size_t Arity = 2, bheap_sift Sift = bheap_sift::top_down>
     class bheap {
+        static_assert(Arity >= 2, "A heap node needs at least two children");
     public:
         using container_type = Container;
         using value_type = typename Container::value_type;
@@ -24,6 +45,26 @@ namespace xilefian {
         using const_reference = typename Container::const_reference;
         using iterator = typename Container::iterator;
 
+        constexpr bheap() noexcept = default;
+
+        constexpr explicit bheap(const Compare& comparator) noexcept : m_comparator{comparator} {}
+
+        /**
+         * Adopts container and arranges it into a heap in O(n)
+         */
+        constexpr explicit bheap(container_type&& container, const Compare& comparator = Compare()) noexcept : m_heap{std::move(container)}, m_comparator{comparator} {
+            make_heap();
+        }
+
+        constexpr explicit bheap(const container_type& container, const Compare& comparator = Compare()) noexcept : m_heap{container}, m_comparator{comparator} {
+            make_heap();
+        }
+
+        template <class InputIt>
+        constexpr bheap(InputIt first, InputIt last, const Compare& comparator = Compare()) noexcept : m_heap(first, last), m_comparator{comparator} {
+            make_heap();
+        }
+
         [[nodiscard]]
         constexpr bool empty() const noexcept {
             return m_heap.empty();
@@ -54,11 +95,34 @@ namespace xilefian {
         }
 
         constexpr iterator push(value_type&& value) noexcept {
-            m_heap.push_back(value);
+            m_heap.push_back(std::move(value));
             return fix_heap();
         }
 
+        /**
+         * Appends a range, then either sifts each new value up or rebuilds the whole heap, whichever is estimated cheaper
+         */
+        template <class InputIt>
+        constexpr void push_range(InputIt first, InputIt last) noexcept {
+            const auto oldSize = m_heap.size();
+            m_heap.insert(m_heap.end(), first, last);
+            const auto count = m_heap.size() - oldSize;
+
+            // Worst case sift-ups cost about count * height, a rebuild about twice the new size
+            if (count * static_cast<size_type>(std::bit_width(m_heap.size() / Arity + 1)) > 2 * m_heap.size()) {
+                make_heap();
+                return;
+            }
+            for (auto it = std::next(m_heap.begin(), oldSize); it != m_heap.end(); ++it) {
+                sift_up(it);
+            }
+        }
+
         constexpr void pop() noexcept {
+            if constexpr (Sift == bheap_sift::bottom_up) {
+                pop_bottom_up();
+                return;
+            }
             std::iter_swap(m_heap.begin(), std::prev(m_heap.end())); // Move end to front
             m_heap.pop_back();
             fix_heap(m_heap.begin());
@@ -89,7 +153,10 @@ namespace xilefian {
         }
     private:
         constexpr iterator fix_heap() noexcept {
-            auto it = std::prev(m_heap.end());
+            return sift_up(std::prev(m_heap.end()));
+        }
+
+        constexpr iterator sift_up(iterator it) noexcept {
             auto parent = decltype(it){};
             while (it != m_heap.begin()) {
                 parent = iterator_parent(it);
@@ -104,44 +171,82 @@ namespace xilefian {
 
         constexpr void fix_heap(iterator it) noexcept {
             while (true) {
-                auto positive = iterator_positive(it);
-                auto negative = iterator_negative(it);
-                auto largest = it;
-
-                if (positive != m_heap.end() && m_comparator(*largest, *positive)) {
-                    largest = positive;
+                const auto child = iterator_child(it);
+                if (child == m_heap.end()) {
+                    break;
                 }
 
-                if (negative != m_heap.end() && m_comparator(*largest, *negative)) {
-                    largest = negative;
+                const auto largest = largest_child(child);
+                if (!m_comparator(*it, *largest)) {
+                    break;
                 }
+                std::iter_swap(it, largest);
+                it = largest;
+            }
+        }
+
+        constexpr void pop_bottom_up() noexcept {
+            auto value = std::move(m_heap.back());
+            m_heap.pop_back();
+            if (m_heap.empty()) {
+                return;
+            }
 
-                if (largest != it) {
-                    std::iter_swap(it, largest);
-                } else {
+            // Pull the larger child up into the hole until it reaches a leaf, then drop the value in and sift it up
+            auto hole = m_heap.begin();
+            for (auto child = iterator_child(hole); child != m_heap.end(); child = iterator_child(hole)) {
+                const auto largest = largest_child(child);
+                *hole = std::move(*largest);
+                hole = largest;
+            }
+            *hole = std::move(value);
+            sift_up(hole);
+        }
+
+        // Floyd's construction, sifting down every parent from the last one back to the root
+        constexpr void make_heap() noexcept {
+            if (m_heap.size() < 2) {
+                return;
+            }
+            auto it = std::next(m_heap.begin(), (m_heap.size() - 2) / Arity);
+            while (true) {
+                fix_heap(it);
+                if (it == m_heap.begin()) {
                     break;
                 }
+                --it;
             }
         }
 
-        constexpr iterator iterator_parent(iterator it) noexcept {
-            const auto idx = (static_cast<size_type>(std::distance(m_heap.begin(), it)) - 1u) / 2u;
-            if (idx >= m_heap.size()) {
-                return m_heap.end();
+        constexpr iterator largest_child(iterator first) noexcept {
+            const auto remaining = static_cast<size_type>(std::distance(first, m_heap.end()));
+
+            auto largest = first;
+            if (remaining >= Arity) {
+                // Full set of siblings, a fixed trip count the compiler can unroll into selects
+                for (std::size_t ii = 1; ii < Arity; ++ii) {
+                    const auto child = std::next(first, ii);
+                    largest = m_comparator(*largest, *child) ? child : largest;
+                }
+            } else {
+                for (size_type ii = 1; ii < remaining; ++ii) {
+                    const auto child = std::next(first, ii);
+                    largest = m_comparator(*largest, *child) ? child : largest;
+                }
             }
-            return std::next(m_heap.begin(), idx);
+            return largest;
         }
 
-        constexpr iterator iterator_positive(iterator it) noexcept {
-            const auto idx = (static_cast<size_type>(std::distance(m_heap.begin(), it)) * 2u) + 1u;
+        constexpr iterator iterator_parent(iterator it) noexcept {
+            const auto idx = (static_cast<size_type>(std::distance(m_heap.begin(), it)) - 1u) / Arity;
             if (idx >= m_heap.size()) {
                 return m_heap.end();
             }
             return std::next(m_heap.begin(), idx);
         }
 
-        constexpr iterator iterator_negative(iterator it) noexcept {
-            const auto idx = (static_cast<size_type>(std::distance(m_heap.begin(), it)) * 2u) + 2u;
+        constexpr iterator iterator_child(iterator it) noexcept {
+            const auto idx = (static_cast<size_type>(std::distance(m_heap.begin(), it)) * Arity) + 1u;
             if (idx >= m_heap.size()) {
                 return m_heap.end();
             }
@@ -156,8 +261,8 @@ namespace xilefian {
 
 namespace std {
 
-    template <typename T, class Compare, class Container>
-    constexpr void swap(xilefian::bheap<T, Compare, Container>& lhs, xilefian::bheap<T, Compare, Container>& rhs) noexcept {
+    template <typename T, class Compare, class Container, std::size_t Arity, xilefian::bheap_sift Sift>
+    constexpr void swap(xilefian::bheap<T, Compare, Container, Arity, Sift>& lhs, xilefian::bheap<T, Compare, Container, Arity, Sift>& rhs) noexcept {
         lhs.swap(rhs);
     }
 
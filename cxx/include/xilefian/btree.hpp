@@ -9,18 +9,68 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
 #include <iterator>
 #include <memory>
+#include <ranges>
+#include <span>
+#include <utility>
+#include <vector>
 
 #include "bvec.hpp"
+#include "comparator.hpp"
+#include "frozen_btree.hpp"
+#include "subtree.hpp"
 
 namespace xilefian {
 
+    struct btree_parallel_helper;
+
+    /**
+     * How btree reshapes itself on find and emplace
+     */
+    enum class btree_access {
+        direct, // Never restructures
+        splay, // Rotates the accessed node to the root
+        semisplay // Roughly halves the depth of the access path, with about half the rotations of splay
+    };
+
+    /**
+     * Event counters shared by every btree of one type, only maintained when XILEFIAN_BTREE_STATS is defined
+     */
+    struct btree_counters {
+        std::atomic<std::uint64_t> emplaces;
+        std::atomic<std::uint64_t> emplaceComparisons; // Every comparator call of emplace, emplace_unique and emplace_hint, including hint climbs
+        std::atomic<std::uint64_t> advanceSteps; // Nodes stepped through by iterator increments and decrements
+        std::atomic<std::uint64_t> codeSpills; // Iterator path codes that moved to, or grew on, the heap
+    };
+
+    struct btree_stats {
+        std::size_t nodes;
+        std::size_t height;
+        std::size_t maxDepth;
+        double meanDepth;
+        double imbalance; // Height over the height of a perfectly balanced tree of the same size
+        std::vector<std::size_t> depthHistogram; // Node count at each depth, the root is depth 0
+        std::size_t nodeBytes;
+        std::size_t valueBytes;
+
+        std::uint64_t emplaces;
+        std::uint64_t emplaceComparisons;
+        std::uint64_t advanceSteps;
+        std::uint64_t codeSpills;
+    };
+
     template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
     class btree {
     public:
         using value_type = T;
     private:
+        friend struct btree_parallel_helper;
+
         using value_allocator_traits = std::allocator_traits<Allocator>;
         using bool_allocator = value_allocator_traits::template rebind_alloc<bool>;
         using bvec_type = bvec<bool_allocator>;
@@ -57,26 +107,177 @@ namespace xilefian {
             }
         };
 
-        constexpr void recursive_destroy(bnode* node) noexcept {
-            if (node->positive) {
-                recursive_destroy(node->positive);
-            }
-            if (node->negative) {
-                recursive_destroy(node->negative);
-            }
+        template <typename L, typename R>
+        constexpr bool before(const L& lhs, const R& rhs) const noexcept {
+            return ordered_before(m_comparator, lhs, rhs);
+        }
+
+        constexpr void destroy_node(bnode* node) noexcept {
             auto* valuePtr = &node->value;
             node_allocator_traits::destroy(m_nodeAllocator, node);
             m_nodeAllocator.deallocate(node, 1);
             value_allocator_traits::destroy(m_valueAllocator, valuePtr);
             m_valueAllocator.deallocate(valuePtr, 1);
         }
+
+        constexpr void destroy_subtree(bnode* node) noexcept {
+            detail::destroy_subtree(node, [this](bnode* n) {
+                destroy_node(n);
+            });
+        }
+
+        constexpr auto* clone_node(bnode* parent, const value_type& source) noexcept {
+            auto* value = m_valueAllocator.allocate(1);
+            value_allocator_traits::construct(m_valueAllocator, value, source);
+
+            auto* node = m_nodeAllocator.allocate(1);
+            node_allocator_traits::construct(m_nodeAllocator, node, parent, nullptr, nullptr, *value);
+            return node;
+        }
+
+        // Preorder through parent links, walking the source and the copy in lockstep
+        constexpr void clone(const btree& other) noexcept {
+            if (!other.m_root) {
+                return;
+            }
+
+            auto* source = other.m_root;
+            auto* copy = m_root = clone_node(nullptr, source->value);
+            while (source) {
+                if (source == other.m_rightmost) {
+                    m_rightmost = copy;
+                }
+
+                if (source->positive || source->negative) {
+                    const auto which = source->positive != nullptr;
+                    source = source->child(which);
+                    copy = copy->child(which) = clone_node(copy, source->value);
+                    continue;
+                }
+
+                // Climb until a negative side has yet to be copied
+                auto* from = source;
+                source = source->parent;
+                copy = copy->parent;
+                while (source && (source->positive != from || !source->negative)) {
+                    from = source;
+                    source = source->parent;
+                    copy = copy->parent;
+                }
+                if (source) {
+                    source = source->negative;
+                    copy = copy->negative = clone_node(copy, source->value);
+                }
+            }
+        }
+
+        static constexpr auto* leftmost(bnode* node) noexcept {
+            while (node->positive) {
+                node = node->positive;
+            }
+            return node;
+        }
+
+        static constexpr auto* successor(bnode* node) noexcept {
+            if (node->negative) {
+                return leftmost(node->negative);
+            }
+            while (node->parent && node->parent->negative == node) {
+                node = node->parent;
+            }
+            return node->parent;
+        }
+
+        // In-order walk over the nodes through parent links, no path code required
+        class node_walker {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = const T*;
+            using reference = const T&;
+            using iterator_category = std::forward_iterator_tag;
+
+            constexpr explicit node_walker(bnode* node = nullptr) noexcept : m_node{node} {}
+
+            constexpr auto& operator*() const noexcept {
+                return m_node->value;
+            }
+
+            constexpr auto& operator++() noexcept {
+                m_node = successor(m_node);
+                return *this;
+            }
+
+            constexpr auto operator++(int) noexcept -> node_walker {
+                auto copy = *this;
+                m_node = successor(m_node);
+                return copy;
+            }
+
+            constexpr bool operator==(const node_walker& rhs) const noexcept {
+                return m_node == rhs.m_node;
+            }
+
+            constexpr bool operator!=(const node_walker& rhs) const noexcept {
+                return m_node != rhs.m_node;
+            }
+        private:
+            bnode* m_node;
+        };
     public:
         constexpr explicit btree(const Allocator allocator = Allocator()) noexcept : m_valueAllocator{allocator}, m_nodeAllocator{allocator}, m_boolAllocator{allocator} {}
 
+        constexpr explicit btree(const Compare& comparator, const Allocator allocator = Allocator()) noexcept : m_valueAllocator{allocator}, m_nodeAllocator{allocator}, m_boolAllocator{allocator}, m_comparator{comparator} {}
+
+        /**
+         * Clones the shape of other in one preorder pass, no comparisons are made
+         */
+        constexpr btree(const btree& other) noexcept : btree{other.m_comparator, value_allocator_traits::select_on_container_copy_construction(other.m_valueAllocator)} {
+            m_access = other.m_access;
+            clone(other);
+        }
+
+        constexpr btree& operator=(const btree& other) noexcept {
+            if (this != &other) {
+                clear();
+                if constexpr (value_allocator_traits::propagate_on_container_copy_assignment::value) {
+                    m_valueAllocator = other.m_valueAllocator;
+                    m_nodeAllocator = node_allocator{other.m_valueAllocator};
+                    m_boolAllocator = bool_allocator{other.m_valueAllocator};
+                }
+                m_comparator = other.m_comparator;
+                m_access = other.m_access;
+                clone(other);
+            }
+            return *this;
+        }
+
+        constexpr btree(btree&& other) noexcept : m_valueAllocator{other.m_valueAllocator}, m_nodeAllocator{other.m_nodeAllocator}, m_boolAllocator{other.m_boolAllocator}, m_comparator{std::move(other.m_comparator)}, m_root{std::exchange(other.m_root, nullptr)}, m_rightmost{std::exchange(other.m_rightmost, nullptr)}, m_access{other.m_access} {}
+
+        constexpr btree& operator=(btree&& other) noexcept {
+            if (this != &other) {
+                clear();
+                m_valueAllocator = other.m_valueAllocator;
+                m_nodeAllocator = other.m_nodeAllocator;
+                m_boolAllocator = other.m_boolAllocator;
+                m_comparator = std::move(other.m_comparator);
+                m_root = std::exchange(other.m_root, nullptr);
+                m_rightmost = std::exchange(other.m_rightmost, nullptr);
+                m_access = other.m_access;
+            }
+            return *this;
+        }
+
         constexpr ~btree() noexcept {
+            clear();
+        }
+
+        constexpr void clear() noexcept {
             if (m_root) {
-                recursive_destroy(m_root);
+                destroy_subtree(m_root);
             }
+            m_root = nullptr;
+            m_rightmost = nullptr;
         }
 
         [[nodiscard]]
@@ -84,12 +285,35 @@ namespace xilefian {
             return m_root == nullptr;
         }
 
+        [[nodiscard]]
+        constexpr auto key_comp() const noexcept -> Compare {
+            return m_comparator;
+        }
+
+        [[nodiscard]]
+        constexpr auto access() const noexcept {
+            return m_access;
+        }
+
+        /**
+         * Self-adjusting modes move hot values towards the root, but every find then invalidates the path codes of other iterators
+         */
+        constexpr void set_access(btree_access access) noexcept {
+            m_access = access;
+        }
+
         class iterator {
         public:
+            constexpr iterator() noexcept : m_node{}, m_code{}, m_isEnd{true} {}
+
             constexpr auto& operator*() noexcept {
                 return m_node->value;
             }
 
+            constexpr auto* operator->() noexcept {
+                return &m_node->value;
+            }
+
             constexpr auto& operator++() noexcept {
                 advance<true>();
                 return *this;
@@ -130,18 +354,23 @@ namespace xilefian {
         private:
             friend class btree;
 
-            constexpr iterator(bnode* node, bvec_type&& code) noexcept : m_node{node}, m_code{code}, m_isEnd{} {}
-            constexpr iterator(bnode* node, bvec_type&& code, std::nullptr_t) noexcept : m_node{node}, m_code{code}, m_isEnd{true} {}
+            constexpr iterator(bnode* node, bvec_type&& code) noexcept : m_node{node}, m_code{std::move(code)}, m_isEnd{} {}
+            constexpr iterator(bnode* node, bvec_type&& code, std::nullptr_t) noexcept : m_node{node}, m_code{std::move(code)}, m_isEnd{true} {}
 
             template <bool Forward>
             constexpr void advance() noexcept {
+                [[maybe_unused]] const auto size = m_code.size();
+                [[maybe_unused]] const auto capacity = m_code.capacity();
+                walk<Forward>();
+                tally<&btree_counters::advanceSteps>(size < m_code.size() ? m_code.size() - size : size - m_code.size());
+                tally<&btree_counters::codeSpills>(m_code.capacity() != capacity);
+            }
+
+            template <bool Forward>
+            constexpr void walk() noexcept {
                 if (m_isEnd) {
                     if constexpr (!Forward) {
-                        if (m_node->parent) {
-                            m_node = m_node->parent;
-                        } else {
-                            m_isEnd = false;
-                        }
+                        m_isEnd = false; // End sits on the maximum
                     }
                     return;
                 }
@@ -184,54 +413,115 @@ namespace xilefian {
             auto* value = m_valueAllocator.allocate(1);
             value_allocator_traits::construct(m_valueAllocator, value, std::forward<Args>(args)...);
 
+            auto it = link(nullptr, &m_root, bvec_type{m_boolAllocator}, value);
+            if (m_access != btree_access::direct) {
+                return restructure(it.m_node);
+            }
+            return it;
+        }
+
+        /**
+         * Inserts a value constructed from args unless an equal value is present, in a single descent
+         * Three-way comparators stop at the equal value, boolean ones make one extra comparison at the bottom
+         */
+        template <typename... Args>
+        constexpr auto emplace_unique(Args&&... args) noexcept -> std::pair<iterator, bool> {
+            auto* value = m_valueAllocator.allocate(1);
+            value_allocator_traits::construct(m_valueAllocator, value, std::forward<Args>(args)...);
+
             bvec_type code{m_boolAllocator};
             bnode* parent = nullptr;
-            auto** node = &m_root;
-            while (*node) {
-                parent = *node;
-                if (m_comparator(*value, (*node)->value)) {
-                    node = &(*node)->positive;
-                    code.push_back(true);
+            auto** slot = &m_root;
+            bnode* equal = nullptr; // Boolean comparators: greatest value on the path not ordered after value
+            auto equalDepth = code.size();
+            [[maybe_unused]] std::uint64_t comparisons = 0;
+            while (*slot) {
+                parent = *slot;
+                ++comparisons; // One comparator call per node either way
+
+                bool positive;
+                if constexpr (three_way_comparator<Compare, T>) {
+                    const auto order = m_comparator(*value, parent->value);
+                    if (order == 0) {
+                        equal = parent;
+                        equalDepth = code.size();
+                        break;
+                    }
+                    positive = order < 0;
                 } else {
-                    node = &(*node)->negative;
-                    code.push_back(false);
+                    positive = before(*value, parent->value);
+                    if (!positive) {
+                        equal = parent;
+                        equalDepth = code.size();
+                    }
                 }
+
+                slot = &parent->child(positive);
+                code.push_back(positive);
             }
 
-            *node = m_nodeAllocator.allocate(1);
-            node_allocator_traits::construct(m_nodeAllocator, *node, parent, nullptr, nullptr, *value);
-            return iterator{*node, std::move(code)};
+            if constexpr (!three_way_comparator<Compare, T>) {
+                comparisons += equal != nullptr;
+                if (equal && before(equal->value, *value)) {
+                    equal = nullptr;
+                }
+            }
+            tally<&btree_counters::emplaceComparisons>(comparisons);
+
+            if (equal) {
+                value_allocator_traits::destroy(m_valueAllocator, value);
+                m_valueAllocator.deallocate(value, 1);
+                code.resize(equalDepth);
+                if (m_access != btree_access::direct) {
+                    return {restructure(equal), false};
+                }
+                return {iterator{equal, std::move(code)}, false};
+            }
+
+            auto it = link(parent, slot, std::move(code), value);
+            if (m_access != btree_access::direct) {
+                return {restructure(it.m_node), true};
+            }
+            return {std::move(it), true};
+        }
+
+        constexpr auto insert_unique(const value_type& value) noexcept {
+            return emplace_unique(value); // Calls copy constructor
+        }
+
+        constexpr auto insert_unique(value_type&& value) noexcept {
+            return emplace_unique(std::move(value)); // Calls move constructor
         }
 
+        /**
+         * Inserts starting from hint, only climbing as far as needed to find the subtree the value belongs in
+         * Inserting at or after the maximum with the previous result (or end()) as the hint is O(1)
+         * Pass the hint as an rvalue to reuse its path code instead of copying it
+         */
         template <typename... Args>
         constexpr auto emplace_hint(iterator hint, Args&&... args) noexcept -> iterator {
             auto* value = m_valueAllocator.allocate(1);
             value_allocator_traits::construct(m_valueAllocator, value, std::forward<Args>(args)...);
 
-            auto* parent = hint.m_node;
-            auto code = hint.m_code;
-            while (parent->parent && code.back() != m_comparator(*value, parent->parent->value)) {
-                code.pop_back();
-                parent = parent->parent;
+            if (!hint.m_node) {
+                return link(nullptr, &m_root, std::move(hint.m_code), value);
             }
 
-            auto** node = &parent->child(code.emplace_back(m_comparator(*value, parent->value)));
-            while (*node) {
-                parent = *node;
-                if (m_comparator(*value, (*node)->value)) {
-                    node = &(*node)->positive;
-                    code.push_back(true);
-                } else {
-                    node = &(*node)->negative;
-                    code.push_back(false);
-                }
+            // Sequential append
+            tally<&btree_counters::emplaceComparisons>(hint.m_node == m_rightmost);
+            if (hint.m_node == m_rightmost && !before(*value, m_rightmost->value)) {
+                hint.m_code.push_back(false);
+                return link(m_rightmost, &m_rightmost->negative, std::move(hint.m_code), value);
             }
 
-            *node = m_nodeAllocator.allocate(1);
-            node_allocator_traits::construct(m_nodeAllocator, *node, parent, nullptr, nullptr, *value);
-            return iterator{*node, std::move(code)};
+            [[maybe_unused]] std::uint64_t comparisons = 0;
+            auto* start = climb(hint.m_node, hint.m_code, [&](const bnode* node) {
+                ++comparisons;
+                return before(*value, node->value);
+            }).node;
+            tally<&btree_counters::emplaceComparisons>(comparisons);
+            return link(start->parent, slot(start, hint.m_code), std::move(hint.m_code), value);
         }
-
         constexpr auto insert(const value_type& value) noexcept {
             return emplace(value); // Calls copy constructor
         }
@@ -241,15 +531,46 @@ namespace xilefian {
         }
 
         constexpr auto insert_hint(iterator hint, const value_type& value) noexcept {
-            return emplace_hint(hint, value); // Calls copy constructor
+            return emplace_hint(std::move(hint), value); // Calls copy constructor
         }
 
         constexpr auto insert_hint(iterator hint, value_type&& value) noexcept {
-            return emplace_hint(hint, value); // Calls move constructor
+            return emplace_hint(std::move(hint), value); // Calls move constructor
+        }
+
+        /**
+         * Inserts a range already ordered by the comparator, each value using the previous one as its hint
+         * An empty tree is filled as a chain of O(1) appends and then rebalanced, so it ends up balanced in O(n)
+         */
+        template <class InputIt>
+        constexpr void insert_sorted(InputIt first, InputIt last) noexcept {
+            const auto wasEmpty = !m_root;
+            auto hint = end();
+            for (; first != last; ++first) {
+                hint = emplace_hint(std::move(hint), *first);
+            }
+            if (wasEmpty) {
+                rebalance();
+            }
+        }
+
+        /**
+         * Sorts a copy of the range and merges it in with insert_sorted
+         */
+        template <class InputIt>
+        constexpr void insert_batch(InputIt first, InputIt last) noexcept {
+            std::vector<value_type, Allocator> batch(first, last, m_valueAllocator);
+            std::sort(batch.begin(), batch.end(), [this](const value_type& lhs, const value_type& rhs) {
+                return before(lhs, rhs);
+            });
+            insert_sorted(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
         }
 
         constexpr auto begin() noexcept -> iterator {
             bvec_type code{m_boolAllocator};
+            if (!m_root) {
+                return iterator{nullptr, std::move(code), nullptr};
+            }
             auto* node = m_root;
             while (node->positive) {
                 node = node->positive;
@@ -260,6 +581,9 @@ namespace xilefian {
 
         constexpr auto end() noexcept -> iterator {
             bvec_type code{m_boolAllocator};
+            if (!m_root) {
+                return iterator{nullptr, std::move(code), nullptr};
+            }
             auto* node = m_root;
             while (node->negative) {
                 node = node->negative;
@@ -267,7 +591,724 @@ namespace xilefian {
             }
             return iterator{node, std::move(code), nullptr};
         }
+
+        /**
+         * First value not ordered before key
+         */
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) noexcept -> iterator {
+            bvec_type code{m_boolAllocator};
+            bnode* found = nullptr;
+            auto foundDepth = code.size();
+            for (auto* node = m_root; node; ) {
+                if (before(node->value, key)) {
+                    node = node->negative;
+                    code.push_back(false);
+                } else {
+                    found = node;
+                    foundDepth = code.size();
+                    node = node->positive;
+                    code.push_back(true);
+                }
+            }
+
+            if (!found) {
+                return end();
+            }
+            code.resize(foundDepth);
+            return iterator{found, std::move(code)};
+        }
+
+        /**
+         * First value ordered after key
+         */
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) noexcept -> iterator {
+            bvec_type code{m_boolAllocator};
+            bnode* found = nullptr;
+            auto foundDepth = code.size();
+            for (auto* node = m_root; node; ) {
+                if (!before(key, node->value)) {
+                    node = node->negative;
+                    code.push_back(false);
+                } else {
+                    found = node;
+                    foundDepth = code.size();
+                    node = node->positive;
+                    code.push_back(true);
+                }
+            }
+
+            if (!found) {
+                return end();
+            }
+            code.resize(foundDepth);
+            return iterator{found, std::move(code)};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) noexcept -> iterator {
+            auto it = lower_bound(key);
+            if (it.m_isEnd || before(key, *it)) {
+                return end();
+            }
+            if (m_access != btree_access::direct) {
+                return restructure(it.m_node);
+            }
+            return it;
+        }
+
+        /**
+         * lower_bound of many keys at once. Descents are interleaved in groups, each step prefetches the next node of
+         * every key in the group before any of them is compared, so memory latency overlaps across keys
+         * @param keys Keys to search for, any contiguous range such as a vector, array or span
+         * @param results Receives lower_bound(keys[i]) for each key (Must be at least as large as keys)
+         */
+        template <std::ranges::contiguous_range Keys> requires std::ranges::sized_range<Keys>
+        constexpr void lower_bound_batch(const Keys& keys, std::span<iterator> results) noexcept {
+            batch<false>(std::span{std::ranges::data(keys), std::ranges::size(keys)}, results);
+        }
+
+        /**
+         * find of many keys at once, see lower_bound_batch
+         */
+        template <std::ranges::contiguous_range Keys> requires std::ranges::sized_range<Keys>
+        constexpr void find_batch(const Keys& keys, std::span<iterator> results) noexcept {
+            batch<true>(std::span{std::ranges::data(keys), std::ranges::size(keys)}, results);
+        }
+
+        /**
+         * lower_bound starting from finger, climbing only until the subtree containing key is found
+         */
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(iterator finger, const K& key) noexcept -> iterator {
+            if (!finger.m_node) {
+                return lower_bound(key);
+            }
+
+            const auto climbed = climb(finger.m_node, finger.m_code, [&](const bnode* node) {
+                return !before(node->value, key);
+            });
+
+            auto& code = finger.m_code;
+            auto* found = climbed.upper;
+            auto foundDepth = climbed.upperDepth;
+            for (auto* node = climbed.node; node; ) {
+                if (before(node->value, key)) {
+                    node = node->negative;
+                    code.push_back(false);
+                } else {
+                    found = node;
+                    foundDepth = code.size();
+                    node = node->positive;
+                    code.push_back(true);
+                }
+            }
+
+            if (!found) {
+                return end();
+            }
+            code.resize(foundDepth);
+            return iterator{found, std::move(code)};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(iterator finger, const K& key) noexcept -> iterator {
+            auto it = lower_bound(std::move(finger), key);
+            if (!it.m_isEnd && before(key, *it)) {
+                return end();
+            }
+            return it;
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) noexcept {
+            return !find(key).m_isEnd;
+        }
+
+        /**
+         * Copies the values into an immutable, contiguous snapshot laid out in Eytzinger order
+         */
+        [[nodiscard]]
+        constexpr auto freeze() const noexcept -> frozen_btree<T, Compare, Allocator> {
+            const auto first = node_walker{m_root ? leftmost(m_root) : nullptr};
+            return frozen_btree<T, Compare, Allocator>{first, node_walker{}, m_comparator, m_valueAllocator};
+        }
+
+        /**
+         * Measures the shape of the tree in one in-order walk. Event counters are zero unless XILEFIAN_BTREE_STATS is defined
+         */
+        [[nodiscard]]
+        auto stats() const noexcept -> btree_stats {
+            btree_stats result{};
+
+            std::size_t depthSum = 0;
+            std::size_t depth = 0;
+            auto* node = m_root;
+            while (node && node->positive) {
+                node = node->positive;
+                ++depth;
+            }
+            while (node) {
+                if (depth >= result.depthHistogram.size()) {
+                    result.depthHistogram.resize(depth + 1);
+                }
+                ++result.depthHistogram[depth];
+                ++result.nodes;
+                depthSum += depth;
+
+                // In-order successor, tracking depth
+                if (node->negative) {
+                    node = node->negative;
+                    ++depth;
+                    while (node->positive) {
+                        node = node->positive;
+                        ++depth;
+                    }
+                } else {
+                    while (node->parent && node->parent->negative == node) {
+                        node = node->parent;
+                        --depth;
+                    }
+                    node = node->parent;
+                    --depth;
+                }
+            }
+
+            result.height = result.depthHistogram.size();
+            if (result.nodes) {
+                result.maxDepth = result.height - 1;
+                result.meanDepth = static_cast<double>(depthSum) / static_cast<double>(result.nodes);
+                result.imbalance = static_cast<double>(result.height) / static_cast<double>(std::bit_width(result.nodes));
+            }
+            result.nodeBytes = result.nodes * sizeof(bnode);
+            result.valueBytes = result.nodes * sizeof(value_type);
+
+#if defined(XILEFIAN_BTREE_STATS)
+            result.emplaces = s_counters.emplaces.load(std::memory_order_relaxed);
+            result.emplaceComparisons = s_counters.emplaceComparisons.load(std::memory_order_relaxed);
+            result.advanceSteps = s_counters.advanceSteps.load(std::memory_order_relaxed);
+            result.codeSpills = s_counters.codeSpills.load(std::memory_order_relaxed);
+#endif
+            return result;
+        }
+
+        /**
+         * Zeroes the event counters of this btree type
+         */
+        static void reset_counters() noexcept {
+#if defined(XILEFIAN_BTREE_STATS)
+            s_counters.emplaces.store(0, std::memory_order_relaxed);
+            s_counters.emplaceComparisons.store(0, std::memory_order_relaxed);
+            s_counters.advanceSteps.store(0, std::memory_order_relaxed);
+            s_counters.codeSpills.store(0, std::memory_order_relaxed);
+#endif
+        }
+
+        /**
+         * Calls fn with every value in order
+         */
+        template <class Fn>
+        constexpr void for_each(Fn fn) const noexcept {
+            for (auto* node = m_root ? leftmost(m_root) : nullptr; node; node = successor(node)) {
+                fn(std::as_const(node->value));
+            }
+        }
+
+        /**
+         * Reallocates every node in in-order sequence, so a scan walks memory front to back. The shape is unchanged
+         * Iterators are invalidated. Values keep their addresses unless moveValues is set, which reallocates each value next to its node
+         * All new nodes are allocated before any old one is released, so freed memory is not reused mid-pass
+         */
+        constexpr void compact(bool moveValues = false) noexcept {
+            bnode* graveyard = nullptr; // Finished old nodes, chained through parent
+            bnode* copy = nullptr;
+            auto* node = m_root ? leftmost(m_root) : nullptr;
+            while (node) {
+                auto* value = &node->value;
+                if (moveValues) {
+                    value = m_valueAllocator.allocate(1);
+                    value_allocator_traits::construct(m_valueAllocator, value, std::move(node->value));
+                }
+                copy = m_nodeAllocator.allocate(1);
+                node_allocator_traits::construct(m_nodeAllocator, copy, nullptr, nullptr, nullptr, *value);
+
+                // The positive subtree and a parent above a negative link are done, their copies are reached through positive
+                if (auto* child = node->positive) {
+                    copy->positive = child->positive;
+                    copy->positive->parent = copy;
+                    child->parent = std::exchange(graveyard, child);
+                }
+                if (!node->parent) {
+                    m_root = copy;
+                } else if (node->parent->negative == node) {
+                    copy->parent = node->parent->positive;
+                    copy->parent->negative = copy;
+                }
+                node->positive = copy; // Never read by the successor step below
+
+                if (node->negative) {
+                    node = leftmost(node->negative);
+                    continue;
+                }
+                while (node->parent && node->parent->negative == node) {
+                    auto* parent = node->parent;
+                    node->parent = std::exchange(graveyard, node);
+                    node = parent;
+                }
+                if (!node->parent) {
+                    node->parent = std::exchange(graveyard, node);
+                    break;
+                }
+                node = node->parent;
+            }
+            m_rightmost = copy;
+
+            while (graveyard) {
+                auto* valuePtr = &graveyard->value;
+                auto* next = graveyard->parent;
+                node_allocator_traits::destroy(m_nodeAllocator, graveyard);
+                m_nodeAllocator.deallocate(graveyard, 1);
+                if (moveValues) {
+                    value_allocator_traits::destroy(m_valueAllocator, valuePtr);
+                    m_valueAllocator.deallocate(valuePtr, 1);
+                }
+                graveyard = next;
+            }
+        }
+
+        /**
+         * Restructures the existing nodes into a balanced shape (Day-Stout-Warren), in O(n) time and O(1) space
+         * No node or value moves in memory, but the path codes of all iterators are invalidated
+         */
+        constexpr void rebalance() noexcept {
+            // Right rotations until every node hangs off the negative side
+            std::size_t count = 0;
+            bnode* parent = nullptr;
+            auto** slot = &m_root;
+            while (*slot) {
+                auto* node = *slot;
+                if (node->positive) {
+                    auto* pivot = node->positive;
+                    node->positive = pivot->negative;
+                    if (pivot->negative) {
+                        pivot->negative->parent = node;
+                    }
+                    pivot->negative = node;
+                    node->parent = pivot;
+                    pivot->parent = parent;
+                    *slot = pivot;
+                } else {
+                    parent = node;
+                    slot = &node->negative;
+                    ++count;
+                }
+            }
+
+            // Fold the vine back up, the first pass places the leftovers of the bottom level
+            auto full = (std::bit_floor(count + 1)) - 1;
+            compress(count - full);
+            while (full > 1) {
+                full /= 2;
+                compress(full);
+            }
+        }
+
+        /**
+         * Moves every value into two trees, values ordered before key go left and the rest go right
+         * Runs in O(height), no node is reallocated. Leaves this tree empty
+         */
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto split(const K& key) noexcept -> std::pair<btree, btree> {
+            std::pair<btree, btree> result{btree{m_comparator, m_valueAllocator}, btree{m_comparator, m_valueAllocator}};
+            split_nodes(std::exchange(m_root, nullptr), key, result.first.m_root, result.second.m_root);
+            m_rightmost = nullptr;
+            result.first.m_rightmost = rightmost(result.first.m_root);
+            result.second.m_rightmost = rightmost(result.second.m_root);
+            return result;
+        }
+
+        /**
+         * Concatenates two trees where no value in right is ordered before any value in left
+         * The maximum of left becomes the new root, so the height is at most one more than the taller input
+         */
+        [[nodiscard]]
+        static constexpr auto join(btree&& left, btree&& right) noexcept -> btree {
+            if (!left.m_root) {
+                return std::move(right);
+            }
+
+            auto* max = left.m_root;
+            while (max->negative) {
+                max = max->negative;
+            }
+
+            // Unlink max, its positive subtree takes its place
+            if (max->positive) {
+                max->positive->parent = max->parent;
+            }
+            if (max->parent) {
+                max->parent->negative = max->positive;
+            } else {
+                left.m_root = max->positive;
+            }
+
+            max->parent = nullptr;
+            max->positive = left.m_root;
+            max->negative = std::exchange(right.m_root, nullptr);
+            left.m_rightmost = right.m_rightmost ? std::exchange(right.m_rightmost, nullptr) : max;
+            for (auto* child : {max->positive, max->negative}) {
+                if (child) {
+                    child->parent = max;
+                }
+            }
+            left.m_root = max;
+            return std::move(left);
+        }
+
+        /**
+         * Moves every node of other into this tree without reallocating, by splitting this tree around the roots of other
+         */
+        constexpr void merge(btree& other) noexcept {
+            m_root = merge_nodes(m_root, std::exchange(other.m_root, nullptr));
+            if (m_root) {
+                m_root->parent = nullptr;
+            }
+            m_rightmost = rightmost(m_root);
+            other.m_rightmost = nullptr;
+        }
+
+        constexpr void merge(btree&& other) noexcept {
+            merge(other);
+        }
     private:
+        static constexpr void prefetch(const void* address) noexcept {
+            if (!std::is_constant_evaluated()) {
+                __builtin_prefetch(address);
+            }
+        }
+
+        template <bool Exact, typename K>
+        constexpr void batch(std::span<const K> keys, std::span<iterator> results) noexcept {
+            constexpr auto group = std::size_t{16};
+
+            struct probe {
+                bnode* node;
+                bnode* found;
+                typename bvec_type::size_type foundDepth;
+                bvec_type code;
+            };
+
+            iterator last{};
+            auto lastValid = false;
+
+            probe probes[group];
+            for (std::size_t base = 0; base < keys.size(); base += group) {
+                const auto count = std::min(group, keys.size() - base);
+                for (std::size_t ii = 0; ii < count; ++ii) {
+                    probes[ii] = probe{m_root, nullptr, 0, bvec_type{m_boolAllocator}};
+                }
+
+                auto active = m_root ? count : 0;
+                while (active) {
+                    // Nodes were prefetched last step, now fetch the values they reference
+                    for (std::size_t ii = 0; ii < count; ++ii) {
+                        if (probes[ii].node) {
+                            prefetch(&probes[ii].node->value);
+                        }
+                    }
+
+                    active = 0;
+                    for (std::size_t ii = 0; ii < count; ++ii) {
+                        auto& current = probes[ii];
+                        if (!current.node) {
+                            continue;
+                        }
+
+                        if (before(current.node->value, keys[base + ii])) {
+                            current.node = current.node->negative;
+                            current.code.push_back(false);
+                        } else {
+                            current.found = current.node;
+                            current.foundDepth = current.code.size();
+                            current.node = current.node->positive;
+                            current.code.push_back(true);
+                        }
+
+                        if (current.node) {
+                            prefetch(current.node);
+                            ++active;
+                        }
+                    }
+                }
+
+                for (std::size_t ii = 0; ii < count; ++ii) {
+                    auto& current = probes[ii];
+                    if (current.found && (!Exact || !before(keys[base + ii], current.found->value))) {
+                        current.code.resize(current.foundDepth);
+                        results[base + ii] = iterator{current.found, std::move(current.code)};
+                    } else {
+                        if (!lastValid) {
+                            last = end();
+                            lastValid = true;
+                        }
+                        results[base + ii] = last;
+                    }
+                }
+            }
+        }
+
+        // Left rotation of every other node down the negative spine
+        constexpr void compress(std::size_t count) noexcept {
+            bnode* parent = nullptr;
+            auto** slot = &m_root;
+            while (count--) {
+                auto* node = *slot;
+                auto* pivot = node->negative;
+                node->negative = pivot->positive;
+                if (pivot->positive) {
+                    pivot->positive->parent = node;
+                }
+                pivot->positive = node;
+                node->parent = pivot;
+                pivot->parent = parent;
+                *slot = pivot;
+                parent = pivot;
+                slot = &pivot->negative;
+            }
+        }
+
+        // Lifts node above its parent, in-order sequence is unchanged
+        constexpr void rotate(bnode* node) noexcept {
+            auto* parent = node->parent;
+            const auto positive = parent->positive == node;
+
+            auto*& inner = node->child(!positive);
+            parent->child(positive) = inner;
+            if (inner) {
+                inner->parent = parent;
+            }
+            inner = parent;
+
+            node->parent = parent->parent;
+            (node->parent ? node->parent->child(node->parent->positive == parent) : m_root) = node;
+            parent->parent = node;
+        }
+
+        template <auto Counter>
+        static constexpr void tally([[maybe_unused]] std::uint64_t amount) noexcept {
+#if defined(XILEFIAN_BTREE_STATS)
+            if (!std::is_constant_evaluated()) {
+                (s_counters.*Counter).fetch_add(amount, std::memory_order_relaxed);
+            }
+#endif
+        }
+
+        constexpr void splay(bnode* node) noexcept {
+            while (auto* parent = node->parent) {
+                if (auto* grandparent = parent->parent) {
+                    const auto zigzig = (grandparent->positive == parent) == (parent->positive == node);
+                    rotate(zigzig ? parent : node);
+                }
+                rotate(node);
+            }
+        }
+
+        // Sleator and Tarjan's semi-splay: a zig-zig only lifts the parent, then carries on from there
+        constexpr void semisplay(bnode* node) noexcept {
+            while (node->parent && node->parent->parent) {
+                auto* parent = node->parent;
+                auto* grandparent = parent->parent;
+                if ((grandparent->positive == parent) == (parent->positive == node)) {
+                    rotate(parent);
+                    node = parent;
+                } else {
+                    rotate(node);
+                    rotate(node);
+                }
+            }
+        }
+
+        constexpr auto code_of(bnode* node) const noexcept -> bvec_type {
+            typename bvec_type::size_type depth = 0;
+            for (auto* ancestor = node; ancestor->parent; ancestor = ancestor->parent) {
+                ++depth;
+            }
+
+            bvec_type code{m_boolAllocator};
+            code.resize(depth);
+            for (; node->parent; node = node->parent) {
+                code[--depth] = node->parent->positive == node;
+            }
+            return code;
+        }
+
+        constexpr auto restructure(bnode* node) noexcept -> iterator {
+            if (m_access == btree_access::splay) {
+                splay(node);
+                return iterator{node, bvec_type{m_boolAllocator}};
+            }
+            semisplay(node);
+            return iterator{node, code_of(node)};
+        }
+
+        struct climb_result {
+            bnode* node;
+            bnode* upper; // Nearest ancestor of node entered through its positive side, when known
+            typename bvec_type::size_type upperDepth;
+        };
+
+        /**
+         * Climbs from node to the lowest ancestor whose subtree a search steering by goPositive would enter, truncating code to it
+         * goPositive must be monotone in the node value. Only ancestors that bound the current subtree are tested
+         */
+        template <class GoPositive>
+        constexpr auto climb(bnode* node, bvec_type& code, GoPositive goPositive) noexcept -> climb_result {
+            climb_result result{node, nullptr, 0};
+            auto startDepth = code.size();
+            auto depth = code.size();
+            auto lowerOk = false;
+            auto upperOk = false;
+            while (node->parent && !(lowerOk && upperOk)) {
+                auto* parent = node->parent;
+                --depth;
+                if (code[depth]) {
+                    // parent bounds the subtree from above
+                    if (!upperOk) {
+                        if (goPositive(parent)) {
+                            upperOk = true;
+                            result.upper = parent;
+                            result.upperDepth = depth;
+                        } else {
+                            result.node = parent; // Monotonicity implies the lower bound of parent is fine
+                            startDepth = depth;
+                            lowerOk = true;
+                        }
+                    }
+                } else if (!lowerOk) {
+                    // parent bounds the subtree from below
+                    if (!goPositive(parent)) {
+                        lowerOk = true;
+                    } else {
+                        result.node = parent;
+                        startDepth = depth;
+                        upperOk = true;
+                        result.upper = nullptr; // parent itself steers positive, so it is found on the way down
+                    }
+                }
+                node = parent;
+            }
+            code.resize(startDepth);
+            return result;
+        }
+
+        constexpr auto** slot(bnode* node, const bvec_type& code) noexcept {
+            return node->parent ? &node->parent->child(code.back()) : &m_root;
+        }
+
+        // Descends from *node (a child slot of parent) to an empty slot and links value there
+        constexpr auto link(bnode* parent, bnode** node, bvec_type&& code, value_type* value) noexcept -> iterator {
+            tally<&btree_counters::emplaces>(1);
+            [[maybe_unused]] const auto depth = code.size();
+            while (*node) {
+                parent = *node;
+                if (before(*value, parent->value)) {
+                    node = &parent->positive;
+                    code.push_back(true);
+                } else {
+                    node = &parent->negative;
+                    code.push_back(false);
+                }
+            }
+
+            tally<&btree_counters::emplaceComparisons>(code.size() - depth);
+
+            *node = m_nodeAllocator.allocate(1);
+            node_allocator_traits::construct(m_nodeAllocator, *node, parent, nullptr, nullptr, *value);
+            if (!parent || (parent == m_rightmost && node == &parent->negative)) {
+                m_rightmost = *node;
+            }
+            return iterator{*node, std::move(code)};
+        }
+
+        static constexpr auto* rightmost(bnode* node) noexcept {
+            while (node && node->negative) {
+                node = node->negative;
+            }
+            return node;
+        }
+
+        template <typename K>
+        constexpr void split_nodes(bnode* node, const K& key, bnode*& left, bnode*& right) noexcept {
+            auto** leftSlot = &left;
+            auto** rightSlot = &right;
+            bnode* leftParent = nullptr;
+            bnode* rightParent = nullptr;
+            while (node) {
+                if (before(node->value, key)) {
+                    *leftSlot = node;
+                    node->parent = leftParent;
+                    leftParent = node;
+                    leftSlot = &node->negative;
+                    node = node->negative;
+                } else {
+                    *rightSlot = node;
+                    node->parent = rightParent;
+                    rightParent = node;
+                    rightSlot = &node->positive;
+                    node = node->positive;
+                }
+            }
+            *leftSlot = nullptr;
+            *rightSlot = nullptr;
+        }
+
+        constexpr auto merge_nodes(bnode* into, bnode* from) noexcept -> bnode* {
+            // Each task merges into with from and stores the result in slot
+            struct merge_task {
+                bnode** slot;
+                bnode* parent;
+                bnode* into;
+                bnode* from;
+            };
+            using task_allocator = value_allocator_traits::template rebind_alloc<merge_task>;
+
+            bnode* root = nullptr;
+
+            // Iterative so that merging a degenerate tree cannot exhaust the stack
+            std::vector<merge_task, task_allocator> tasks{task_allocator{m_valueAllocator}};
+            tasks.push_back({&root, nullptr, into, from});
+            while (!tasks.empty()) {
+                const auto task = tasks.back();
+                tasks.pop_back();
+
+                if (!task.into || !task.from) {
+                    *task.slot = task.into ? task.into : task.from;
+                    if (*task.slot) {
+                        (*task.slot)->parent = task.parent;
+                    }
+                    continue;
+                }
+
+                bnode* left = nullptr;
+                bnode* right = nullptr;
+                split_nodes(task.into, task.from->value, left, right);
+
+                *task.slot = task.from;
+                task.from->parent = task.parent;
+                tasks.push_back({&task.from->positive, task.from, left, task.from->positive});
+                tasks.push_back({&task.from->negative, task.from, right, task.from->negative});
+            }
+            return root;
+        }
+
         using node_allocator = value_allocator_traits::template rebind_alloc<bnode>;
         using node_allocator_traits = std::allocator_traits<node_allocator>;
 
@@ -276,6 +1317,12 @@ namespace xilefian {
         bool_allocator m_boolAllocator{}; // For iterator codes
         Compare m_comparator;
         bnode* m_root{};
+        bnode* m_rightmost{}; // Maximum, for the sequential append fast path
+        btree_access m_access{btree_access::direct};
+
+#if defined(XILEFIAN_BTREE_STATS)
+        static inline btree_counters s_counters{};
+#endif
     };
 
 }
@@ -0,0 +1,253 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "btree.hpp"
+#include "frozen_btree.hpp"
+
+namespace xilefian {
+
+    /**
+     * Leads every image file. Values follow at data_offset in frozen_btree's Eytzinger layout, including the unused slot 0
+     * Images hold raw object bytes, so they only load on a machine with the same value layout and byte order
+     */
+    struct btree_image_header {
+        static constexpr char signature[8] = {'X', 'B', 'T', 'R', 'E', 'E', 'I', '1'};
+        static constexpr auto data_offset = static_cast<std::size_t>(64);
+
+        char magic[8];
+        std::uint64_t count;
+        std::uint64_t valueSize;
+        std::uint64_t valueAlign;
+    };
+
+    namespace detail {
+
+        /**
+         * Creates path sized for count values, maps it and lets fill write the slots
+         */
+        template <typename T, class Fill>
+        bool write_image(const char* path, std::size_t count, Fill fill) noexcept {
+            static_assert(std::is_trivially_copyable_v<T>, "Images hold raw object bytes");
+            static_assert(alignof(T) <= btree_image_header::data_offset);
+
+            // count + 1 slots must fit alongside the header without the length wrapping
+            constexpr auto max_length = static_cast<std::size_t>(std::numeric_limits<off_t>::max());
+            if (count >= (max_length - btree_image_header::data_offset) / sizeof(T)) {
+                return false;
+            }
+            const auto length = btree_image_header::data_offset + (count + 1) * sizeof(T);
+
+            const auto fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0) {
+                return false;
+            }
+            if (::ftruncate(fd, static_cast<off_t>(length)) != 0) {
+                ::close(fd);
+                return false;
+            }
+
+            auto* base = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                return false;
+            }
+
+            btree_image_header header{};
+            std::memcpy(header.magic, btree_image_header::signature, sizeof(header.magic));
+            header.count = count;
+            header.valueSize = sizeof(T);
+            header.valueAlign = alignof(T);
+            std::memcpy(base, &header, sizeof(header));
+
+            fill(static_cast<char*>(base) + btree_image_header::data_offset);
+
+            const auto synced = ::msync(base, length, MS_SYNC) == 0;
+            ::munmap(base, length);
+            return synced;
+        }
+
+    }
+
+    /**
+     * Writes tree to path as an image that mapped_btree can search in place
+     */
+    template <typename T, class Compare, class Allocator>
+    bool save(const btree<T, Compare, Allocator>& tree, const char* path) noexcept {
+        using frozen_type = frozen_btree<T, Compare, Allocator>;
+
+        std::size_t count = 0;
+        tree.for_each([&count](const T&) {
+            ++count;
+        });
+
+        // Values are written straight into their final slots, no second in-memory copy of the tree is built
+        return detail::write_image<T>(path, count, [&](char* data) {
+            auto k = frozen_type::first_index(count);
+            tree.for_each([&](const T& value) {
+                std::memcpy(data + k * sizeof(T), &value, sizeof(T));
+                k = frozen_type::next_index(k, count);
+            });
+        });
+    }
+
+    template <typename T, class Compare, class Allocator>
+    bool save(const frozen_btree<T, Compare, Allocator>& tree, const char* path) noexcept {
+        return detail::write_image<T>(path, tree.size(), [&tree](char* data) {
+            if (!tree.empty()) {
+                std::memcpy(data + sizeof(T), tree.data() + 1, tree.size() * sizeof(T));
+            }
+        });
+    }
+
+    /**
+     * Read-only frozen_btree over a mapped image file, pages are loaded on demand as lookups touch them
+     * Iterators refer to this object and are invalidated when it moves
+     */
+    template <typename T, class Compare = std::less<T>>
+    class mapped_btree {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using tree_type = frozen_btree<T, Compare>;
+        using iterator = typename tree_type::iterator;
+
+        /**
+         * @return The mapped image, or nothing if path cannot be mapped or does not hold an image of T
+         */
+        [[nodiscard]]
+        static auto map(const char* path, const Compare& comparator = Compare()) noexcept -> std::optional<mapped_btree> {
+            static_assert(std::is_trivially_copyable_v<T>, "Images hold raw object bytes");
+
+            const auto fd = ::open(path, O_RDONLY);
+            if (fd < 0) {
+                return std::nullopt;
+            }
+
+            struct stat status{};
+            if (::fstat(fd, &status) != 0 || static_cast<std::size_t>(status.st_size) < btree_image_header::data_offset) {
+                ::close(fd);
+                return std::nullopt;
+            }
+
+            const auto length = static_cast<std::size_t>(status.st_size);
+            auto* base = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (base == MAP_FAILED) {
+                return std::nullopt;
+            }
+
+            btree_image_header header;
+            std::memcpy(&header, base, sizeof(header));
+            // Slots 0 to count must lie inside the file, checked by division so a corrupt count cannot wrap around
+            if (std::memcmp(header.magic, btree_image_header::signature, sizeof(header.magic)) != 0 ||
+                header.valueSize != sizeof(T) || header.valueAlign != alignof(T) ||
+                header.count >= (length - btree_image_header::data_offset) / sizeof(T)) {
+                ::munmap(base, length);
+                return std::nullopt;
+            }
+
+            const auto* data = reinterpret_cast<const T*>(static_cast<const char*>(base) + btree_image_header::data_offset);
+            return mapped_btree{base, length, tree_type{data, static_cast<size_type>(header.count), comparator}};
+        }
+
+        mapped_btree(const mapped_btree&) = delete;
+        mapped_btree& operator=(const mapped_btree&) = delete;
+
+        mapped_btree(mapped_btree&& other) noexcept : m_base{std::exchange(other.m_base, nullptr)}, m_length{std::exchange(other.m_length, 0)}, m_tree{std::move(other.m_tree)} {}
+
+        mapped_btree& operator=(mapped_btree&& other) noexcept {
+            if (this != &other) {
+                unmap();
+                m_base = std::exchange(other.m_base, nullptr);
+                m_length = std::exchange(other.m_length, 0);
+                m_tree = std::move(other.m_tree);
+            }
+            return *this;
+        }
+
+        ~mapped_btree() noexcept {
+            unmap();
+        }
+
+        [[nodiscard]]
+        auto tree() const noexcept -> const tree_type& {
+            return m_tree;
+        }
+
+        [[nodiscard]]
+        auto empty() const noexcept {
+            return m_tree.empty();
+        }
+
+        [[nodiscard]]
+        auto size() const noexcept {
+            return m_tree.size();
+        }
+
+        auto begin() const noexcept -> iterator {
+            return m_tree.begin();
+        }
+
+        auto end() const noexcept -> iterator {
+            return m_tree.end();
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        auto lower_bound(const K& key) const noexcept -> iterator {
+            return m_tree.lower_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        auto upper_bound(const K& key) const noexcept -> iterator {
+            return m_tree.upper_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        auto find(const K& key) const noexcept -> iterator {
+            return m_tree.find(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        bool contains(const K& key) const noexcept {
+            return m_tree.contains(key);
+        }
+    private:
+        mapped_btree(void* base, std::size_t length, tree_type&& tree) noexcept : m_base{base}, m_length{length}, m_tree{std::move(tree)} {}
+
+        void unmap() noexcept {
+            if (m_base) {
+                ::munmap(m_base, m_length);
+            }
+        }
+
+        void* m_base{};
+        std::size_t m_length{};
+        tree_type m_tree;
+    };
+
+}
@@ -0,0 +1,237 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <utility>
+
+#include "btree.hpp"
+#include "comparator.hpp"
+
+namespace xilefian {
+
+    /**
+     * Orders key-value pairs by key alone, returning whatever Compare returns. Also compares pairs against bare keys, so lookups never build a pair
+     * Overloads are chosen by the node type Value, so keys that are pairs themselves stay unambiguous
+     */
+    template <class Compare, typename Value>
+    struct btree_key_compare {
+        using is_transparent = void;
+
+        constexpr auto operator()(const Value& lhs, const Value& rhs) const noexcept {
+            return comparator(lhs.first, rhs.first);
+        }
+
+        template <typename K>
+        constexpr auto operator()(const Value& lhs, const K& rhs) const noexcept requires (!std::same_as<K, Value>) {
+            return comparator(lhs.first, rhs);
+        }
+
+        template <typename K>
+        constexpr auto operator()(const K& lhs, const Value& rhs) const noexcept requires (!std::same_as<K, Value>) {
+            return comparator(lhs, rhs.first);
+        }
+
+        [[no_unique_address]] Compare comparator;
+    };
+
+    template <typename Key, typename T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<const Key, T>>>
+    class btree_multimap {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = std::pair<const Key, T>;
+        using key_compare = Compare;
+    protected:
+        using tree_type = btree<value_type, btree_key_compare<Compare, value_type>, Allocator>;
+
+        static constexpr auto transparent = requires { typename Compare::is_transparent; };
+    public:
+        using iterator = typename tree_type::iterator;
+
+        constexpr explicit btree_multimap(const Allocator allocator = Allocator()) noexcept : m_tree{allocator} {}
+
+        constexpr explicit btree_multimap(const Compare& comparator, const Allocator allocator = Allocator()) noexcept : m_tree{{comparator}, allocator} {}
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_tree.empty();
+        }
+
+        constexpr auto begin() noexcept -> iterator {
+            return m_tree.begin();
+        }
+
+        constexpr auto end() noexcept -> iterator {
+            return m_tree.end();
+        }
+
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> iterator {
+            return m_tree.emplace(std::forward<Args>(args)...);
+        }
+
+        constexpr auto insert(const value_type& value) noexcept -> iterator {
+            return m_tree.emplace(value); // Calls copy constructor
+        }
+
+        constexpr auto insert(value_type&& value) noexcept -> iterator {
+            return m_tree.emplace(std::move(value)); // Calls move constructor
+        }
+
+        [[nodiscard]]
+        constexpr auto lower_bound(const key_type& key) noexcept -> iterator {
+            return m_tree.lower_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) noexcept -> iterator requires transparent {
+            return m_tree.lower_bound(key);
+        }
+
+        [[nodiscard]]
+        constexpr auto upper_bound(const key_type& key) noexcept -> iterator {
+            return m_tree.upper_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) noexcept -> iterator requires transparent {
+            return m_tree.upper_bound(key);
+        }
+
+        [[nodiscard]]
+        constexpr auto find(const key_type& key) noexcept -> iterator {
+            return m_tree.find(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) noexcept -> iterator requires transparent {
+            return m_tree.find(key);
+        }
+
+        [[nodiscard]]
+        constexpr bool contains(const key_type& key) noexcept {
+            return m_tree.contains(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) noexcept requires transparent {
+            return m_tree.contains(key);
+        }
+
+        [[nodiscard]]
+        constexpr auto equal_range(const key_type& key) noexcept -> std::pair<iterator, iterator> {
+            return {m_tree.lower_bound(key), m_tree.upper_bound(key)};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto equal_range(const K& key) noexcept -> std::pair<iterator, iterator> requires transparent {
+            return {m_tree.lower_bound(key), m_tree.upper_bound(key)};
+        }
+    protected:
+        tree_type m_tree;
+    };
+
+    /**
+     * Each key at most once. Inherits privately, so it cannot be reached as a btree_multimap and given duplicates
+     */
+    template <typename Key, typename T, class Compare = std::less<Key>, class Allocator = std::allocator<std::pair<const Key, T>>>
+    class btree_map : private btree_multimap<Key, T, Compare, Allocator> {
+        using base_type = btree_multimap<Key, T, Compare, Allocator>;
+        using base_type::m_tree;
+    public:
+        using typename base_type::key_type;
+        using typename base_type::mapped_type;
+        using typename base_type::value_type;
+        using typename base_type::key_compare;
+        using typename base_type::iterator;
+
+        using base_type::base_type;
+
+        using base_type::empty;
+        using base_type::begin;
+        using base_type::end;
+        using base_type::lower_bound;
+        using base_type::upper_bound;
+        using base_type::find;
+        using base_type::contains;
+        using base_type::equal_range;
+
+        /**
+         * Inserts a value constructed from args, unless key is already present. Args are untouched when nothing is inserted
+         */
+        template <typename... Args>
+        constexpr auto try_emplace(const key_type& key, Args&&... args) noexcept -> std::pair<iterator, bool> {
+            auto it = m_tree.lower_bound(key);
+            if (it != m_tree.end() && !ordered_before(m_tree.key_comp(), key, *it)) {
+                return {std::move(it), false};
+            }
+            return {m_tree.emplace_hint(std::move(it), std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)), true};
+        }
+
+        template <typename... Args>
+        constexpr auto try_emplace(key_type&& key, Args&&... args) noexcept -> std::pair<iterator, bool> {
+            auto it = m_tree.lower_bound(key);
+            if (it != m_tree.end() && !ordered_before(m_tree.key_comp(), key, *it)) {
+                return {std::move(it), false};
+            }
+            return {m_tree.emplace_hint(std::move(it), std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...)), true};
+        }
+
+        template <typename M>
+        constexpr auto insert_or_assign(const key_type& key, M&& obj) noexcept -> std::pair<iterator, bool> {
+            auto result = try_emplace(key, std::forward<M>(obj));
+            if (!result.second) {
+                result.first->second = std::forward<M>(obj);
+            }
+            return result;
+        }
+
+        template <typename M>
+        constexpr auto insert_or_assign(key_type&& key, M&& obj) noexcept -> std::pair<iterator, bool> {
+            auto result = try_emplace(std::move(key), std::forward<M>(obj));
+            if (!result.second) {
+                result.first->second = std::forward<M>(obj);
+            }
+            return result;
+        }
+
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> std::pair<iterator, bool> {
+            value_type value(std::forward<Args>(args)...);
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        constexpr auto insert(const value_type& value) noexcept -> std::pair<iterator, bool> {
+            return try_emplace(value.first, value.second);
+        }
+
+        constexpr auto insert(value_type&& value) noexcept -> std::pair<iterator, bool> {
+            return try_emplace(value.first, std::move(value.second));
+        }
+
+        constexpr auto& operator[](const key_type& key) noexcept {
+            return try_emplace(key).first->second;
+        }
+
+        constexpr auto& operator[](key_type&& key) noexcept {
+            return try_emplace(std::move(key)).first->second;
+        }
+    };
+
+}
@@ -0,0 +1,223 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <execution>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "btree.hpp"
+
+namespace xilefian {
+
+    struct btree_parallel_helper {
+        template <class Tree>
+        using node_type = typename Tree::bnode;
+
+        template <class Tree>
+        using node_vector = std::vector<node_type<Tree>*, typename Tree::value_allocator_traits::template rebind_alloc<node_type<Tree>*>>;
+
+        static auto piece_target() noexcept -> std::size_t {
+            return std::max(std::thread::hardware_concurrency(), 1u) * 4u;
+        }
+
+        /**
+         * Breaks the top of the tree into independent subtrees, handing each removed top node to visit
+         * Gives up after a bounded number of splits so degenerate trees do not turn this into a serial walk
+         */
+        template <class Tree, class Visit>
+        static auto detach_subtrees(Tree& tree, Visit visit) noexcept -> node_vector<Tree> {
+            node_vector<Tree> pieces{typename node_vector<Tree>::allocator_type{tree.m_nodeAllocator}};
+            if (!tree.m_root) {
+                return pieces;
+            }
+
+            const auto target = piece_target();
+            pieces.push_back(std::exchange(tree.m_root, nullptr));
+            tree.m_rightmost = nullptr;
+
+            for (auto splits = target * 2; splits && pieces.size() < target; --splits) {
+                auto widest = std::find_if(pieces.begin(), pieces.end(), [](const auto* node) {
+                    return node->positive || node->negative;
+                });
+                if (widest == pieces.end()) {
+                    break;
+                }
+
+                auto* node = *widest;
+                pieces.erase(widest);
+                for (auto* child : {node->positive, node->negative}) {
+                    if (child) {
+                        child->parent = nullptr;
+                        pieces.push_back(child);
+                    }
+                }
+                node->positive = nullptr;
+                node->negative = nullptr;
+                visit(node);
+            }
+            return pieces;
+        }
+
+        template <class Tree>
+        struct ordered_piece {
+            node_type<Tree>* node;
+            bool whole; // The whole subtree under node, otherwise node alone
+        };
+
+        template <class Tree>
+        using piece_vector = std::vector<ordered_piece<Tree>, typename Tree::value_allocator_traits::template rebind_alloc<ordered_piece<Tree>>>;
+
+        /**
+         * Splits the tree, without modifying it, into pieces whose in-order concatenation is the whole sequence
+         * Every round breaks each subtree piece into its positive subtree, its top node and its negative subtree
+         */
+        template <class Tree>
+        static auto ordered_pieces(Tree& tree) noexcept -> piece_vector<Tree> {
+            using allocator_type = typename piece_vector<Tree>::allocator_type;
+
+            piece_vector<Tree> pieces{allocator_type{tree.m_nodeAllocator}};
+            if (!tree.m_root) {
+                return pieces;
+            }
+            pieces.push_back({tree.m_root, true});
+
+            const auto target = piece_target();
+            piece_vector<Tree> next{allocator_type{tree.m_nodeAllocator}};
+            for (auto rounds = target; rounds && pieces.size() < target; --rounds) {
+                next.clear();
+                for (const auto& piece : pieces) {
+                    if (!piece.whole) {
+                        next.push_back(piece);
+                        continue;
+                    }
+                    if (piece.node->positive) {
+                        next.push_back({piece.node->positive, true});
+                    }
+                    next.push_back({piece.node, false});
+                    if (piece.node->negative) {
+                        next.push_back({piece.node->negative, true});
+                    }
+                }
+                if (next.size() == pieces.size()) {
+                    break; // Only single nodes left
+                }
+                pieces.swap(next);
+            }
+            return pieces;
+        }
+
+        template <class Tree, class Fn>
+        static void visit(const ordered_piece<Tree>& piece, Fn& fn) noexcept {
+            if (!piece.whole) {
+                fn(piece.node->value);
+                return;
+            }
+            auto* const last = Tree::successor(Tree::rightmost(piece.node));
+            for (auto* node = Tree::leftmost(piece.node); node != last; node = Tree::successor(node)) {
+                fn(node->value);
+            }
+        }
+
+        template <class ExecutionPolicy, class Tree, class Fn>
+        static void for_each(ExecutionPolicy&& policy, Tree& tree, Fn fn) noexcept {
+            const auto pieces = ordered_pieces(tree);
+            std::for_each(std::forward<ExecutionPolicy>(policy), pieces.begin(), pieces.end(), [&fn](const auto& piece) {
+                visit<Tree>(piece, fn);
+            });
+        }
+
+        template <class ExecutionPolicy, class Tree, typename R, class Reduce, class Transform>
+        static auto transform_reduce(ExecutionPolicy&& policy, Tree& tree, R init, Reduce reduce, Transform transform) noexcept -> R {
+            const auto pieces = ordered_pieces(tree);
+
+            // Each piece folds its own run in order, the partial results are then folded in piece order
+            std::vector<std::optional<R>, typename Tree::value_allocator_traits::template rebind_alloc<std::optional<R>>> partials(pieces.size(), typename Tree::value_allocator_traits::template rebind_alloc<std::optional<R>>{tree.m_nodeAllocator});
+            std::for_each(std::forward<ExecutionPolicy>(policy), pieces.begin(), pieces.end(), [&](const auto& piece) {
+                auto& partial = partials[static_cast<std::size_t>(&piece - pieces.data())];
+                auto fold = [&](auto& value) {
+                    if (partial) {
+                        *partial = reduce(std::move(*partial), transform(value));
+                    } else {
+                        partial.emplace(transform(value));
+                    }
+                };
+                visit<Tree>(piece, fold);
+            });
+
+            for (auto& partial : partials) {
+                if (partial) {
+                    init = reduce(std::move(init), std::move(*partial));
+                }
+            }
+            return init;
+        }
+
+        template <class ExecutionPolicy, class Tree, class ForwardIt>
+        static void insert_batch(ExecutionPolicy&& policy, Tree& tree, ForwardIt first, ForwardIt last) noexcept {
+            using value_type = typename Tree::value_type;
+
+            std::vector<value_type, typename Tree::value_allocator_traits::allocator_type> batch(first, last, tree.m_valueAllocator);
+            std::sort(std::forward<ExecutionPolicy>(policy), batch.begin(), batch.end(), [&tree](const value_type& lhs, const value_type& rhs) {
+                return tree.before(lhs, rhs);
+            });
+            tree.insert_sorted(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+        }
+
+        template <class ExecutionPolicy, class Tree>
+        static void clear(ExecutionPolicy&& policy, Tree& tree) noexcept {
+            auto pieces = detach_subtrees(tree, [&tree](auto* node) {
+                tree.destroy_node(node);
+            });
+            std::for_each(std::forward<ExecutionPolicy>(policy), pieces.begin(), pieces.end(), [&tree](auto* node) {
+                tree.destroy_subtree(node);
+            });
+        }
+    };
+
+    /**
+     * Destroys every value, tearing independent subtrees down concurrently under policy
+     * The allocator must tolerate concurrent deallocation
+     */
+    template <class ExecutionPolicy, typename T, class Compare, class Allocator>
+    void clear(ExecutionPolicy&& policy, btree<T, Compare, Allocator>& tree) noexcept requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>> {
+        btree_parallel_helper::clear(std::forward<ExecutionPolicy>(policy), tree);
+    }
+
+    /**
+     * btree::insert_batch with the batch sorted under policy
+     */
+    template <class ExecutionPolicy, typename T, class Compare, class Allocator, class ForwardIt>
+    void insert_batch(ExecutionPolicy&& policy, btree<T, Compare, Allocator>& tree, ForwardIt first, ForwardIt last) noexcept requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>> {
+        btree_parallel_helper::insert_batch(std::forward<ExecutionPolicy>(policy), tree, first, last);
+    }
+
+    /**
+     * Calls fn with every value, running disjoint runs of the sequence concurrently under policy
+     * Pieces come from the top of the tree, so a badly unbalanced tree parallelises poorly until it is rebalanced
+     */
+    template <class ExecutionPolicy, typename T, class Compare, class Allocator, class Fn>
+    void for_each(ExecutionPolicy&& policy, btree<T, Compare, Allocator>& tree, Fn fn) noexcept requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>> {
+        btree_parallel_helper::for_each(std::forward<ExecutionPolicy>(policy), tree, std::move(fn));
+    }
+
+    /**
+     * Folds transform(value) over the tree with reduce, concurrently under policy
+     * Values are combined in sequence order, so reduce needs to be associative but not commutative
+     */
+    template <class ExecutionPolicy, typename T, class Compare, class Allocator, typename R, class Reduce, class Transform>
+    auto transform_reduce(ExecutionPolicy&& policy, btree<T, Compare, Allocator>& tree, R init, Reduce reduce, Transform transform) noexcept -> R requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>> {
+        return btree_parallel_helper::transform_reduce(std::forward<ExecutionPolicy>(policy), tree, std::move(init), std::move(reduce), std::move(transform));
+    }
+
+}
@@ -0,0 +1,91 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "btree.hpp"
+
+namespace xilefian {
+
+    /**
+     * btree holding each value at most once. Insertion finds an equal value in the same descent that would place the new one
+     */
+    template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class btree_set {
+    public:
+        using key_type = T;
+        using value_type = T;
+        using key_compare = Compare;
+    protected:
+        using tree_type = btree<value_type, Compare, Allocator>;
+    public:
+        using iterator = typename tree_type::iterator;
+
+        constexpr explicit btree_set(const Allocator allocator = Allocator()) noexcept : m_tree{allocator} {}
+
+        constexpr explicit btree_set(const Compare& comparator, const Allocator allocator = Allocator()) noexcept : m_tree{comparator, allocator} {}
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_tree.empty();
+        }
+
+        constexpr auto begin() noexcept -> iterator {
+            return m_tree.begin();
+        }
+
+        constexpr auto end() noexcept -> iterator {
+            return m_tree.end();
+        }
+
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> std::pair<iterator, bool> {
+            return m_tree.emplace_unique(std::forward<Args>(args)...);
+        }
+
+        constexpr auto insert(const value_type& value) noexcept -> std::pair<iterator, bool> {
+            return m_tree.emplace_unique(value); // Calls copy constructor
+        }
+
+        constexpr auto insert(value_type&& value) noexcept -> std::pair<iterator, bool> {
+            return m_tree.emplace_unique(std::move(value)); // Calls move constructor
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) noexcept -> iterator {
+            return m_tree.lower_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) noexcept -> iterator {
+            return m_tree.upper_bound(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) noexcept -> iterator {
+            return m_tree.find(key);
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) noexcept {
+            return m_tree.contains(key);
+        }
+    protected:
+        tree_type m_tree;
+    };
+
+}
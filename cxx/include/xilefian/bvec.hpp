@@ -9,6 +9,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cstdint>
 #include <initializer_list>
 #include <limits>
@@ -77,7 +78,9 @@ namespace xilefian {
         }
 
         constexpr bvec& operator=(const bvec& other) noexcept {
-            assign(other.cbegin(), other.cend());
+            if (this != &other) {
+                assign(other.cbegin(), other.cend());
+            }
             return *this;
         }
 
@@ -123,19 +126,20 @@ namespace xilefian {
                     m_wordAllocator.deallocate(m_data.heap.pointer, m_data.heap.capacity);
                 }
 
-                if (other.m_data.is_heap()) {
+                if (other.m_data.is_heap() && first.m_pos == last.m_pos) {
+                    m_data.stack = {};
+                } else if (other.m_data.is_heap()) {
                     const auto begin = static_cast<size_type>(first.m_pos);
                     const auto end = static_cast<size_type>(last.m_pos);
                     const auto beginWord = begin / block_digits;
                     const auto beginBit = begin % block_digits;
                     const auto endWord = block_round(end);
-                    const auto endBit = end % block_digits;
                     const auto words = endWord - beginWord;
 
-                    // Copy entire words
+                    // Copy entire words, the leading bits of the first word are dropped below
                     m_data.heap = {
                             .is_heap = true,
-                            .size = ((words * block_digits) - endBit) & heap_size_mask,
+                            .size = (end - (beginWord * block_digits)) & heap_size_mask,
                             .capacity = words & heap_capacity_mask,
                             .pointer = m_wordAllocator.allocate(words)
                     };
@@ -542,6 +546,49 @@ namespace xilefian {
             }
         }
 
+        // Reads count bits starting at pos, which may straddle two words
+        [[nodiscard]]
+        constexpr block_type get_bits(size_type pos, size_type count) const noexcept {
+            const auto word = pos / block_digits;
+            const auto offset = pos % block_digits;
+
+            auto bits = m_data.heap.pointer[word] >> offset;
+            if (offset && offset + count > block_digits) {
+                bits |= m_data.heap.pointer[word + 1] << (block_digits - offset);
+            }
+            return count == block_digits ? bits : bits & ((static_cast<block_type>(1) << count) - 1);
+        }
+
+        // Writes count bits starting at pos, which must not straddle two words
+        constexpr void set_bits(size_type pos, size_type count, block_type bits) noexcept {
+            const auto word = pos / block_digits;
+            const auto offset = pos % block_digits;
+
+            const auto mask = (count == block_digits ? block_mask : (static_cast<block_type>(1) << count) - 1) << offset;
+            m_data.heap.pointer[word] = (m_data.heap.pointer[word] & ~mask) | ((bits << offset) & mask);
+        }
+
+        constexpr void erase_heap(size_type begin, size_type end) noexcept {
+            const auto size = static_cast<size_type>(m_data.heap.size);
+            if (begin >= end) {
+                return;
+            }
+            if (end >= size) {
+                m_data.heap.size = begin & heap_size_mask;
+                return;
+            }
+
+            // Move the tail down one destination word (or less) at a time
+            auto dst = begin;
+            for (auto src = end; src < size;) {
+                const auto count = std::min(block_digits - (dst % block_digits), size - src);
+                set_bits(dst, count, get_bits(src, count));
+                dst += count;
+                src += count;
+            }
+            m_data.heap.size = (size - (end - begin)) & heap_size_mask;
+        }
+
         constexpr void flip_at(size_type pos) noexcept {
             if (m_data.is_heap()) {
                 const auto word = pos / block_digits;
@@ -789,25 +836,8 @@ namespace xilefian {
         }
 
         constexpr iterator erase(const_iterator pos) noexcept {
-            constexpr auto carry_bit = (static_cast<block_type>(1) << (block_digits - 1));
-
             if (m_data.is_heap()) {
-                const auto posWord = static_cast<size_type>(pos.m_pos) / block_digits;
-                const auto posWordSize = static_cast<size_type>(pos.m_pos) % block_digits;
-
-                bool carry = false;
-                auto lastWord = m_data.heap.size / block_digits;
-                while (lastWord > posWord) {
-                    const auto carryBit = carry ? carry_bit : 0;
-                    carry = m_data.heap.pointer[lastWord] & 1;
-                    m_data.heap.pointer[lastWord] >>= 1;
-                    m_data.heap.pointer[lastWord] |= carryBit;
-                    --lastWord;
-                }
-
-                const auto upper = m_data.heap.pointer[posWord] >> (posWordSize + 1);
-                const auto lower = m_data.heap.pointer[posWord] & ((static_cast<block_type>(1) << posWordSize) - 1);
-                m_data.heap.pointer[posWord] = (carry ? carry_bit : 0) | (upper << posWordSize) | lower;
+                erase_heap(static_cast<size_type>(pos.m_pos), static_cast<size_type>(pos.m_pos) + 1);
             } else {
                 const auto upper = m_data.stack.data >> (pos.m_pos + 1);
                 const auto lower = m_data.stack.data & ((static_cast<stack_data_type>(1) << pos.m_pos) - 1);
@@ -819,84 +849,9 @@ namespace xilefian {
 
         constexpr iterator erase(const_iterator first, const_iterator last) noexcept {
             if (m_data.is_heap()) {
-                if (last.m_pos > m_data.heap.size) {
-                    m_data.heap.size = static_cast<size_type>(first.m_pos) & heap_size_mask;
-                } else {
-                    auto firstBlock = static_cast<size_type>(first.m_pos) / block_digits;
-                    auto firstBit = static_cast<size_type>(first.m_pos) % block_digits;
-
-                    auto lastBlock = static_cast<size_type>(last.m_pos) / block_digits;
-                    auto lastBit = static_cast<size_type>(last.m_pos) % block_digits;
-
-                    // Handle first block
-                    if (firstBlock == lastBlock) {
-                        const auto upperMask = block_mask << lastBit;
-                        const auto lowerMask = (static_cast<block_type>(1) << firstBit) - 1;
-
-                        const auto endBlock = block_round(m_data.heap.size);
-                        auto& data = m_data.heap.pointer;
-
-                        data[firstBlock] = (data[firstBlock] & lowerMask) |
-                                             ((data[firstBlock] & upperMask) >> (lastBit - firstBit));
-
-                        ++lastBlock;
-                        if (lastBlock < endBlock) {
-                            data[firstBlock] |= data[lastBlock] << (block_digits - lastBit - firstBit);
-                        }
-                        ++firstBlock;
-
-                        lastBit = (lastBit + block_digits - firstBit) % block_digits;
-                        firstBit = 0;
-                    } else if (firstBit) {
-                        const auto lowerMask = (static_cast<block_type>(1) << firstBit) - 1;
-
-                        const auto endBlock = block_round(m_data.heap.size);
-                        auto& data = m_data.heap.pointer;
-
-                        data[firstBlock] = (data[firstBlock] & lowerMask) |
-                                             ((data[lastBlock] >> lastBit) << firstBit);
-
-                        ++lastBlock;
-                        if (firstBit < lastBit && lastBlock < endBlock) {
-                            data[firstBlock] |= data[lastBlock] << (firstBit + block_digits - lastBit);
-                        }
-                        ++firstBlock;
-
-                        lastBit = (lastBit + block_digits - firstBit) % block_digits;
-                        firstBit = 0;
-                    }
-
-                    const auto firstByteAlign = firstBit % 8;
-                    const auto lastByteAlign = lastBit % 8;
-
-                    // Handle remaining blocks
-                    if (firstByteAlign == 0 && lastByteAlign == 0) {
-                        const auto firstByte = (firstBlock * sizeof(block_type)) + (firstBit / 8);
-                        const auto lastByte = (lastBlock * sizeof(block_type)) + (lastBit / 8);
-
-                        const auto endByte = (m_data.heap.size + 7) / 8;
-                        const auto numBytes = endByte - lastByte;
-
-                        auto* data8 = reinterpret_cast<std::uint8_t*>(m_data.heap.pointer);
-                        __builtin_memcpy(&data8[firstByte], &data8[lastByte], numBytes);
-                    } else if (lastBlock > firstBlock) {
-                        const auto blockSpan = lastBlock - firstBlock;
-
-                        auto& data = m_data.heap.pointer;
-
-                        for (auto ii = 0u; ii < blockSpan; ++ii) {
-                            data[firstBlock + ii] = (data[lastBlock + ii] >> lastBit) |
-                                                      (data[lastBlock + ii + 1] << (block_digits - lastBit));
-                        }
-
-                        // Shift last block
-                        data[firstBlock + blockSpan] = data[lastBlock + blockSpan] >> lastBit;
-                    }
-
-                    m_data.heap.size = (m_data.heap.size - static_cast<size_type>(last.m_pos - first.m_pos)) & heap_size_mask;
-                }
+                erase_heap(static_cast<size_type>(first.m_pos), static_cast<size_type>(last.m_pos));
             } else {
-                if (last.m_pos > m_data.stack.size) {
+                if (last.m_pos >= m_data.stack.size) {
                     m_data.stack.size = static_cast<size_type>(first.m_pos) & stack_size_mask;
                 } else {
                     const auto start = static_cast<size_type>(first.m_pos);
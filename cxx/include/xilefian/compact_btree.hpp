@@ -0,0 +1,294 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+namespace xilefian {
+
+    /**
+     * Unbalanced binary tree whose nodes live in one growable arena and link through 32-bit indices.
+     * Values are stored inline after the links. Growing the arena relocates values, but indices (and iterators) stay valid.
+     * Index links carry no addresses, so the arena can be copied or mapped elsewhere as-is.
+     */
+    template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class compact_btree {
+    public:
+        using value_type = T;
+        using index_type = std::uint32_t;
+        using size_type = std::size_t;
+
+        static constexpr auto null_index = static_cast<index_type>(~0u);
+    private:
+        struct cnode {
+            index_type parent;
+            index_type positive;
+            index_type negative;
+            value_type value;
+
+            [[nodiscard]]
+            constexpr auto& child(bool which) noexcept {
+                return which ? positive : negative;
+            }
+
+            [[nodiscard]]
+            constexpr auto child(bool which) const noexcept {
+                return which ? positive : negative;
+            }
+        };
+
+        using node_allocator = std::allocator_traits<Allocator>::template rebind_alloc<cnode>;
+    public:
+        constexpr explicit compact_btree(const Allocator allocator = Allocator()) noexcept : m_nodes{node_allocator{allocator}} {}
+
+        constexpr explicit compact_btree(const Compare& comparator, const Allocator allocator = Allocator()) noexcept : m_nodes{node_allocator{allocator}}, m_comparator{comparator} {}
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_nodes.empty();
+        }
+
+        [[nodiscard]]
+        constexpr auto size() const noexcept -> size_type {
+            return m_nodes.size();
+        }
+
+        /**
+         * Every index below null_index can name a node
+         */
+        [[nodiscard]]
+        static constexpr auto max_size() noexcept -> size_type {
+            return null_index;
+        }
+
+        constexpr void reserve(size_type count) noexcept {
+            m_nodes.reserve(count);
+        }
+
+        constexpr void clear() noexcept {
+            m_nodes.clear();
+            m_root = null_index;
+            m_rightmost = null_index;
+        }
+
+        class iterator {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = T*;
+            using reference = T&;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            constexpr iterator() noexcept = default;
+
+            constexpr auto& operator*() const noexcept {
+                return m_owner->m_nodes[m_index].value;
+            }
+
+            constexpr auto* operator->() const noexcept {
+                return &m_owner->m_nodes[m_index].value;
+            }
+
+            constexpr auto& operator++() noexcept {
+                m_index = m_owner->template step<true>(m_index);
+                return *this;
+            }
+
+            constexpr auto operator++(int) noexcept -> iterator {
+                auto copy = *this;
+                ++*this;
+                return copy;
+            }
+
+            constexpr auto& operator--() noexcept {
+                m_index = m_index == null_index ? m_owner->m_rightmost : m_owner->template step<false>(m_index);
+                return *this;
+            }
+
+            constexpr auto operator--(int) noexcept -> iterator {
+                auto copy = *this;
+                --*this;
+                return copy;
+            }
+
+            constexpr bool operator==(const iterator& rhs) const noexcept {
+                return m_index == rhs.m_index;
+            }
+
+            constexpr bool operator!=(const iterator& rhs) const noexcept {
+                return m_index != rhs.m_index;
+            }
+
+            [[nodiscard]]
+            constexpr auto index() const noexcept {
+                return m_index;
+            }
+        private:
+            friend class compact_btree;
+
+            constexpr iterator(compact_btree* owner, index_type index) noexcept : m_owner{owner}, m_index{index} {}
+
+            compact_btree* m_owner{};
+            index_type m_index{null_index};
+        };
+
+        /**
+         * @return Iterator to the inserted value, or end() without constructing it once max_size() nodes exist
+         */
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> iterator {
+            if (m_nodes.size() >= max_size()) {
+                return end(); // The next index would be null_index
+            }
+
+            const auto index = static_cast<index_type>(m_nodes.size());
+            m_nodes.push_back(cnode{null_index, null_index, null_index, value_type(std::forward<Args>(args)...)});
+            descend(index);
+            return iterator{this, index};
+        }
+
+        /**
+         * Appending at or after the maximum with end() or the previous maximum as the hint is O(1), other hints fall back to emplace
+         */
+        template <typename... Args>
+        constexpr auto emplace_hint(iterator hint, Args&&... args) noexcept -> iterator {
+            if (m_rightmost == null_index || (hint.m_index != null_index && hint.m_index != m_rightmost)) {
+                return emplace(std::forward<Args>(args)...);
+            }
+            if (m_nodes.size() >= max_size()) {
+                return end();
+            }
+
+            const auto index = static_cast<index_type>(m_nodes.size());
+            m_nodes.push_back(cnode{null_index, null_index, null_index, value_type(std::forward<Args>(args)...)});
+            if (m_comparator(m_nodes[index].value, m_nodes[m_rightmost].value)) {
+                descend(index);
+            } else {
+                link(m_rightmost, &m_nodes[m_rightmost].negative, index);
+            }
+            return iterator{this, index};
+        }
+
+        constexpr auto insert(const value_type& value) noexcept {
+            return emplace(value); // Calls copy constructor
+        }
+
+        constexpr auto insert(value_type&& value) noexcept {
+            return emplace(std::move(value)); // Calls move constructor
+        }
+
+        constexpr auto begin() noexcept -> iterator {
+            return iterator{this, m_root == null_index ? null_index : extreme<true>(m_root)};
+        }
+
+        constexpr auto end() noexcept -> iterator {
+            return iterator{this, null_index};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) noexcept -> iterator {
+            auto found = null_index;
+            for (auto index = m_root; index != null_index; ) {
+                const auto& node = m_nodes[index];
+                if (m_comparator(node.value, key)) {
+                    index = node.negative;
+                } else {
+                    found = index;
+                    index = node.positive;
+                }
+            }
+            return iterator{this, found};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) noexcept -> iterator {
+            auto found = null_index;
+            for (auto index = m_root; index != null_index; ) {
+                const auto& node = m_nodes[index];
+                if (!m_comparator(key, node.value)) {
+                    index = node.negative;
+                } else {
+                    found = index;
+                    index = node.positive;
+                }
+            }
+            return iterator{this, found};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) noexcept -> iterator {
+            auto it = lower_bound(key);
+            if (it.m_index != null_index && m_comparator(key, m_nodes[it.m_index].value)) {
+                return end();
+            }
+            return it;
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) noexcept {
+            return find(key).m_index != null_index;
+        }
+    private:
+        constexpr void descend(index_type index) noexcept {
+            auto parent = null_index;
+            auto* slot = &m_root;
+            while (*slot != null_index) {
+                parent = *slot;
+                slot = &m_nodes[parent].child(m_comparator(m_nodes[index].value, m_nodes[parent].value));
+            }
+            link(parent, slot, index);
+        }
+
+        constexpr void link(index_type parent, index_type* slot, index_type index) noexcept {
+            const auto rightmost = parent == null_index || (parent == m_rightmost && slot == &m_nodes[parent].negative);
+            *slot = index;
+            m_nodes[index].parent = parent;
+            if (rightmost) {
+                m_rightmost = index;
+            }
+        }
+
+        template <bool Positive>
+        constexpr auto extreme(index_type index) const noexcept {
+            while (m_nodes[index].child(Positive) != null_index) {
+                index = m_nodes[index].child(Positive);
+            }
+            return index;
+        }
+
+        // In-order neighbour through parent links, Forward steps towards the negative side
+        template <bool Forward>
+        constexpr auto step(index_type index) const noexcept -> index_type {
+            if (m_nodes[index].child(!Forward) != null_index) {
+                return extreme<Forward>(m_nodes[index].child(!Forward));
+            }
+            auto parent = m_nodes[index].parent;
+            while (parent != null_index && m_nodes[parent].child(!Forward) == index) {
+                index = parent;
+                parent = m_nodes[parent].parent;
+            }
+            return parent;
+        }
+
+        std::vector<cnode, node_allocator> m_nodes;
+        Compare m_comparator;
+        index_type m_root{null_index};
+        index_type m_rightmost{null_index};
+    };
+
+}
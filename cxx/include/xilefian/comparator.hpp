@@ -0,0 +1,37 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <compare>
+#include <concepts>
+
+namespace xilefian {
+
+    /**
+     * Comparators that return an ordering rather than a bool, such as std::compare_three_way
+     */
+    template <class Compare, typename L, typename R = L>
+    concept three_way_comparator = requires (const Compare& comparator, const L& lhs, const R& rhs) {
+        { comparator(lhs, rhs) } -> std::convertible_to<std::partial_ordering>;
+    };
+
+    /**
+     * Whether lhs goes before rhs, for boolean and three-way comparators alike
+     */
+    template <class Compare, typename L, typename R>
+    constexpr bool ordered_before(const Compare& comparator, const L& lhs, const R& rhs) noexcept {
+        if constexpr (three_way_comparator<Compare, L, R>) {
+            return comparator(lhs, rhs) < 0;
+        } else {
+            return comparator(lhs, rhs);
+        }
+    }
+
+}
@@ -0,0 +1,189 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace xilefian {
+
+    /**
+     * Unbalanced binary tree safe for concurrent emplace, find and erase without locks.
+     * Nodes are only ever linked into empty child slots, so a compare-exchange on that slot publishes an insert.
+     * Erase marks the node as a tombstone that keeps routing searches, tombstones are reclaimed with the tree.
+     * Nothing is freed while the tree is alive: memory grows with every emplace, erased or not, so a workload
+     * with churn must be bounded by periodically moving the live values into a fresh tree.
+     */
+    template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class concurrent_btree {
+    public:
+        using value_type = T;
+    private:
+        struct cnode {
+            std::atomic<cnode*> positive;
+            std::atomic<cnode*> negative;
+            std::atomic<bool> erased;
+            value_type value;
+
+            template <typename... Args>
+            cnode(Args&&... args) noexcept : positive{}, negative{}, erased{}, value(std::forward<Args>(args)...) {}
+
+            [[nodiscard]]
+            auto& child(bool which) noexcept {
+                return which ? positive : negative;
+            }
+        };
+
+        using value_allocator_traits = std::allocator_traits<Allocator>;
+        using node_allocator = value_allocator_traits::template rebind_alloc<cnode>;
+        using node_allocator_traits = std::allocator_traits<node_allocator>;
+        using stack_allocator = value_allocator_traits::template rebind_alloc<cnode*>;
+    public:
+        constexpr explicit concurrent_btree(const Allocator allocator = Allocator()) noexcept : m_nodeAllocator{allocator} {}
+
+        concurrent_btree(const concurrent_btree&) = delete;
+        concurrent_btree& operator=(const concurrent_btree&) = delete;
+
+        ~concurrent_btree() noexcept {
+            auto* root = m_root.load(std::memory_order_relaxed);
+            if (!root) {
+                return;
+            }
+
+            std::vector<cnode*, stack_allocator> stack{stack_allocator{m_nodeAllocator}};
+            stack.push_back(root);
+            while (!stack.empty()) {
+                auto* node = stack.back();
+                stack.pop_back();
+                for (auto* child : {node->positive.load(std::memory_order_relaxed), node->negative.load(std::memory_order_relaxed)}) {
+                    if (child) {
+                        stack.push_back(child);
+                    }
+                }
+                node_allocator_traits::destroy(m_nodeAllocator, node);
+                m_nodeAllocator.deallocate(node, 1);
+            }
+        }
+
+        [[nodiscard]]
+        auto empty() const noexcept {
+            return m_root.load(std::memory_order_acquire) == nullptr;
+        }
+
+        /**
+         * Inserts the value, equal values are kept (like btree)
+         * @return Reference to the stored value, stable until the tree is destroyed
+         */
+        template <typename... Args>
+        auto emplace(Args&&... args) noexcept -> const value_type& {
+            auto* inserted = m_nodeAllocator.allocate(1);
+            node_allocator_traits::construct(m_nodeAllocator, inserted, std::forward<Args>(args)...);
+
+            auto* slot = &m_root;
+            auto* node = slot->load(std::memory_order_acquire);
+            while (true) {
+                if (!node) {
+                    if (slot->compare_exchange_weak(node, inserted, std::memory_order_release, std::memory_order_acquire)) {
+                        return inserted->value;
+                    }
+                    continue; // Lost the race, node now holds the winner (or spurious failure left it null)
+                }
+                slot = &node->child(m_comparator(inserted->value, node->value));
+                node = slot->load(std::memory_order_acquire);
+            }
+        }
+
+        auto insert(const value_type& value) noexcept -> const value_type& {
+            return emplace(value); // Calls copy constructor
+        }
+
+        auto insert(value_type&& value) noexcept -> const value_type& {
+            return emplace(std::move(value)); // Calls move constructor
+        }
+
+        /**
+         * @return Pointer to a live value equal to key, or nullptr
+         */
+        template <typename K>
+        [[nodiscard]]
+        auto find(const K& key) const noexcept -> const value_type* {
+            auto* node = m_root.load(std::memory_order_acquire);
+            while (node) {
+                if (m_comparator(key, node->value)) {
+                    node = node->positive.load(std::memory_order_acquire);
+                } else if (m_comparator(node->value, key)) {
+                    node = node->negative.load(std::memory_order_acquire);
+                } else if (node->erased.load(std::memory_order_acquire)) {
+                    node = node->negative.load(std::memory_order_acquire); // Equal values continue on the negative side
+                } else {
+                    return &node->value;
+                }
+            }
+            return nullptr;
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        bool contains(const K& key) const noexcept {
+            return find(key) != nullptr;
+        }
+
+        /**
+         * Erases one value equal to key
+         * @return true if this call erased a value
+         */
+        template <typename K>
+        bool erase(const K& key) noexcept {
+            auto* node = m_root.load(std::memory_order_acquire);
+            while (node) {
+                if (m_comparator(key, node->value)) {
+                    node = node->positive.load(std::memory_order_acquire);
+                } else if (m_comparator(node->value, key)) {
+                    node = node->negative.load(std::memory_order_acquire);
+                } else {
+                    auto expected = false;
+                    if (node->erased.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                        return true;
+                    }
+                    node = node->negative.load(std::memory_order_acquire);
+                }
+            }
+            return false;
+        }
+
+        /**
+         * Visits the live values in order. Concurrent inserts may or may not be observed
+         */
+        template <class Fn>
+        void for_each(Fn fn) const noexcept {
+            std::vector<cnode*, stack_allocator> stack{stack_allocator{m_nodeAllocator}};
+            auto* node = m_root.load(std::memory_order_acquire);
+            while (node || !stack.empty()) {
+                while (node) {
+                    stack.push_back(node);
+                    node = node->positive.load(std::memory_order_acquire);
+                }
+                node = stack.back();
+                stack.pop_back();
+                if (!node->erased.load(std::memory_order_acquire)) {
+                    fn(node->value);
+                }
+                node = node->negative.load(std::memory_order_acquire);
+            }
+        }
+    private:
+        node_allocator m_nodeAllocator{};
+        Compare m_comparator;
+        std::atomic<cnode*> m_root{};
+    };
+
+}
@@ -0,0 +1,366 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+
+#include "comparator.hpp"
+
+namespace xilefian {
+
+    template <typename T, class Compare>
+    class mapped_btree;
+
+    /**
+     * Immutable, contiguous snapshot of a sorted sequence stored in Eytzinger (BFS) order.
+     * Slot k has children 2k and 2k+1, slot 0 is unused and doubles as the end index.
+     * Indices are stable for the lifetime of the snapshot.
+     */
+    template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class frozen_btree {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+        using allocator_type = Allocator;
+    private:
+        using value_allocator_traits = std::allocator_traits<Allocator>;
+
+        static constexpr auto cache_line = static_cast<size_type>(64);
+
+        // Descendants log2(prefetch_stride) levels down are prefetch_stride consecutive slots, at most one cache line of them
+        static constexpr auto prefetch_stride = sizeof(value_type) < cache_line ? std::bit_floor(cache_line / sizeof(value_type)) : static_cast<size_type>(1);
+
+        // Owned storage is allocated in whole cache lines, so slot 0 starts a line
+        struct alignas(alignof(value_type) > cache_line ? alignof(value_type) : cache_line) cache_block {
+            std::byte bytes[cache_line];
+        };
+
+        using block_allocator = value_allocator_traits::template rebind_alloc<cache_block>;
+
+        static constexpr auto batch_group = static_cast<size_type>(16);
+    public:
+        static constexpr auto end_index = static_cast<size_type>(0);
+
+        /**
+         * Slot of the smallest value in a snapshot of size values
+         */
+        static constexpr auto first_index(size_type size) noexcept -> size_type {
+            auto k = static_cast<size_type>(size ? 1 : 0);
+            while (k && 2 * k <= size) {
+                k = 2 * k;
+            }
+            return k;
+        }
+
+        /**
+         * Slot following index in sorted order, end_index after the largest
+         */
+        static constexpr auto next_index(size_type index, size_type size) noexcept -> size_type {
+            if (2 * index + 1 <= size) {
+                index = 2 * index + 1;
+                while (2 * index <= size) {
+                    index = 2 * index;
+                }
+                return index;
+            }
+            return index >> (std::countr_one(index) + 1);
+        }
+
+        constexpr explicit frozen_btree(const Compare& comparator = Compare(), const Allocator& allocator = Allocator()) noexcept : m_allocator{allocator}, m_comparator{comparator} {}
+
+        /**
+         * Builds the snapshot from a range that is already sorted by comparator
+         */
+        template <class ForwardIt>
+        constexpr frozen_btree(ForwardIt first, ForwardIt last, const Compare& comparator = Compare(), const Allocator& allocator = Allocator()) noexcept : m_allocator{allocator}, m_comparator{comparator} {
+            m_size = static_cast<size_type>(std::distance(first, last));
+            if (m_size == 0) {
+                return;
+            }
+
+            auto* data = allocate(m_size);
+
+            // In-order walk of the implicit tree
+            for (auto k = first_index(m_size); k != end_index; k = next_index(k, m_size)) {
+                value_allocator_traits::construct(m_allocator, data + k, *first++);
+            }
+            m_data = data;
+        }
+
+        constexpr frozen_btree(frozen_btree&& other) noexcept : m_allocator{other.m_allocator}, m_comparator{std::move(other.m_comparator)}, m_data{other.m_data}, m_size{other.m_size}, m_borrowed{other.m_borrowed} {
+            other.m_data = nullptr;
+            other.m_size = 0;
+        }
+
+        constexpr frozen_btree& operator=(frozen_btree&& other) noexcept {
+            if (this != &other) {
+                destroy();
+                m_allocator = other.m_allocator;
+                m_comparator = std::move(other.m_comparator);
+                m_data = other.m_data;
+                m_size = other.m_size;
+                m_borrowed = other.m_borrowed;
+                other.m_data = nullptr;
+                other.m_size = 0;
+            }
+            return *this;
+        }
+
+        constexpr ~frozen_btree() noexcept {
+            destroy();
+        }
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_size == 0;
+        }
+
+        [[nodiscard]]
+        constexpr auto size() const noexcept {
+            return m_size;
+        }
+
+        [[nodiscard]]
+        constexpr auto operator[](size_type index) const noexcept -> const value_type& {
+            return m_data[index];
+        }
+
+        /**
+         * Slots 1 to size() in Eytzinger order, slot 0 is unused
+         */
+        [[nodiscard]]
+        constexpr auto data() const noexcept -> const value_type* {
+            return m_data;
+        }
+
+        class iterator {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = T;
+            using pointer = const T*;
+            using reference = const T&;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            constexpr iterator() noexcept = default;
+
+            constexpr auto operator*() const noexcept -> reference {
+                return m_owner->m_data[m_index];
+            }
+
+            constexpr auto operator->() const noexcept -> pointer {
+                return m_owner->m_data + m_index;
+            }
+
+            constexpr auto& operator++() noexcept {
+                m_index = next_index(m_index, m_owner->m_size);
+                return *this;
+            }
+
+            constexpr auto operator++(int) noexcept -> iterator {
+                auto copy = *this;
+                m_index = next_index(m_index, m_owner->m_size);
+                return copy;
+            }
+
+            constexpr auto& operator--() noexcept {
+                m_index = m_owner->prev_index(m_index);
+                return *this;
+            }
+
+            constexpr auto operator--(int) noexcept -> iterator {
+                auto copy = *this;
+                m_index = m_owner->prev_index(m_index);
+                return copy;
+            }
+
+            constexpr bool operator==(const iterator& rhs) const noexcept {
+                return m_index == rhs.m_index;
+            }
+
+            constexpr bool operator!=(const iterator& rhs) const noexcept {
+                return m_index != rhs.m_index;
+            }
+
+            [[nodiscard]]
+            constexpr auto index() const noexcept {
+                return m_index;
+            }
+        private:
+            friend class frozen_btree;
+
+            constexpr iterator(const frozen_btree* owner, size_type index) noexcept : m_owner{owner}, m_index{index} {}
+
+            const frozen_btree* m_owner{};
+            size_type m_index{};
+        };
+
+        constexpr auto begin() const noexcept -> iterator {
+            return iterator{this, first_index(m_size)};
+        }
+
+        constexpr auto end() const noexcept -> iterator {
+            return iterator{this, end_index};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) const noexcept -> iterator {
+            auto k = static_cast<size_type>(1);
+            while (k <= m_size) {
+                prefetch(k);
+                k = 2 * k + static_cast<size_type>(before(m_data[k], key));
+            }
+            return iterator{this, k >> (std::countr_one(k) + 1)};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) const noexcept -> iterator {
+            auto k = static_cast<size_type>(1);
+            while (k <= m_size) {
+                prefetch(k);
+                k = 2 * k + static_cast<size_type>(!before(key, m_data[k]));
+            }
+            return iterator{this, k >> (std::countr_one(k) + 1)};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) const noexcept -> iterator {
+            const auto it = lower_bound(key);
+            if (it.m_index == end_index || before(key, m_data[it.m_index])) {
+                return end();
+            }
+            return it;
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) const noexcept {
+            return find(key) != end();
+        }
+
+        /**
+         * Interleaves the descents of many keys so that the loads of one key overlap with the comparisons of the others
+         * @param keyRange Keys to search for, any contiguous range such as a vector, array or span
+         * @param results Receives lower_bound(keyRange[i]) for each key (Must be at least as large as keyRange)
+         */
+        template <std::ranges::contiguous_range Keys> requires std::ranges::sized_range<Keys>
+        constexpr void lower_bound(const Keys& keyRange, std::span<iterator> results) const noexcept {
+            const std::span keys{std::ranges::data(keyRange), std::ranges::size(keyRange)};
+            const auto levels = static_cast<size_type>(std::bit_width(m_size));
+
+            size_type k[batch_group];
+            for (size_type base = 0; base < keys.size(); base += batch_group) {
+                const auto count = std::min(batch_group, keys.size() - base);
+
+                for (size_type ii = 0; ii < count; ++ii) {
+                    k[ii] = 1;
+                }
+
+                for (size_type level = 0; level < levels; ++level) {
+                    for (size_type ii = 0; ii < count; ++ii) {
+                        if (k[ii] <= m_size) {
+                            prefetch(k[ii]);
+                            k[ii] = 2 * k[ii] + static_cast<size_type>(before(m_data[k[ii]], keys[base + ii]));
+                        }
+                    }
+                }
+
+                for (size_type ii = 0; ii < count; ++ii) {
+                    results[base + ii] = iterator{this, k[ii] >> (std::countr_one(k[ii]) + 1)};
+                }
+            }
+        }
+    private:
+        template <typename L, typename R>
+        constexpr bool before(const L& lhs, const R& rhs) const noexcept {
+            return ordered_before(m_comparator, lhs, rhs);
+        }
+
+        constexpr void prefetch(size_type k) const noexcept {
+            if (!std::is_constant_evaluated()) {
+                // Fetch the descendants log2(prefetch_stride) levels down while comparing this level
+                // With line-aligned storage they fill exactly one line when sizeof(value_type) is a power of two
+                __builtin_prefetch(reinterpret_cast<const char*>(m_data) + (k * prefetch_stride * sizeof(value_type)));
+            }
+        }
+
+        constexpr auto rightmost(size_type k) const noexcept {
+            while (2 * k + 1 <= m_size) {
+                k = 2 * k + 1;
+            }
+            return k;
+        }
+
+        constexpr auto prev_index(size_type k) const noexcept -> size_type {
+            if (k == end_index) {
+                return m_size ? rightmost(1) : end_index;
+            }
+            if (2 * k <= m_size) {
+                return rightmost(2 * k);
+            }
+            return k >> (std::countr_zero(k) + 1);
+        }
+
+        template <typename, class>
+        friend class mapped_btree;
+
+        // Views storage owned elsewhere, such as a read-only mapped file
+        constexpr frozen_btree(const value_type* data, size_type size, const Compare& comparator) noexcept : m_comparator{comparator}, m_data{data}, m_size{size}, m_borrowed{true} {}
+
+        constexpr void destroy() noexcept {
+            if (!m_data || m_borrowed) {
+                return;
+            }
+            // Owned storage was allocated mutable by the range constructor
+            auto* data = const_cast<value_type*>(m_data);
+            for (size_type k = 1; k <= m_size; ++k) {
+                value_allocator_traits::destroy(m_allocator, data + k);
+            }
+            deallocate(data, m_size);
+        }
+
+        static constexpr auto blocks_for(size_type size) noexcept {
+            return ((size + 1) * sizeof(value_type) + cache_line - 1) / cache_line;
+        }
+
+        // Slots 0 to size, cache-line aligned outside of constant evaluation
+        constexpr auto allocate(size_type size) noexcept -> value_type* {
+            if (std::is_constant_evaluated()) {
+                return m_allocator.allocate(size + 1);
+            }
+            block_allocator blocks{m_allocator};
+            return reinterpret_cast<value_type*>(blocks.allocate(blocks_for(size)));
+        }
+
+        constexpr void deallocate(value_type* data, size_type size) noexcept {
+            if (std::is_constant_evaluated()) {
+                return m_allocator.deallocate(data, size + 1);
+            }
+            block_allocator blocks{m_allocator};
+            blocks.deallocate(reinterpret_cast<cache_block*>(data), blocks_for(size));
+        }
+
+        Allocator m_allocator{};
+        Compare m_comparator;
+        const value_type* m_data{};
+        size_type m_size{};
+        bool m_borrowed{};
+    };
+
+}
@@ -0,0 +1,177 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include "subtree.hpp"
+
+namespace xilefian {
+
+    /**
+     * Reads the half-open [lower, upper) range of an interval, defaults to pair-like values
+     */
+    template <typename T>
+    struct interval_endpoints {
+        constexpr auto& lower(const T& value) const noexcept {
+            return value.first;
+        }
+
+        constexpr auto& upper(const T& value) const noexcept {
+            return value.second;
+        }
+    };
+
+    /**
+     * Unbalanced binary tree of intervals ordered by lower endpoint.
+     * Every node also records the greatest upper endpoint in its subtree, so overlap queries skip subtrees that end too early.
+     */
+    template <typename T, class Endpoints = interval_endpoints<T>, class Compare = std::less<>, class Allocator = std::allocator<T>>
+    class interval_btree {
+    public:
+        using value_type = T;
+        using endpoint_type = std::remove_cvref_t<decltype(std::declval<Endpoints>().upper(std::declval<const T&>()))>;
+        using size_type = std::size_t;
+    private:
+        using value_allocator_traits = std::allocator_traits<Allocator>;
+
+        struct bnode {
+            bnode* parent;
+            bnode* positive;
+            bnode* negative;
+            value_type& value;
+            endpoint_type max;
+        };
+
+        using node_allocator = value_allocator_traits::template rebind_alloc<bnode>;
+        using node_allocator_traits = std::allocator_traits<node_allocator>;
+    public:
+        constexpr explicit interval_btree(const Allocator allocator = Allocator()) noexcept : m_valueAllocator{allocator}, m_nodeAllocator{allocator} {}
+
+        interval_btree(const interval_btree&) = delete;
+        interval_btree& operator=(const interval_btree&) = delete;
+
+        constexpr ~interval_btree() noexcept {
+            clear();
+        }
+
+        constexpr void clear() noexcept {
+            if (m_root) {
+                detail::destroy_subtree(m_root, [this](bnode* node) {
+                    auto* valuePtr = &node->value;
+                    node_allocator_traits::destroy(m_nodeAllocator, node);
+                    m_nodeAllocator.deallocate(node, 1);
+                    value_allocator_traits::destroy(m_valueAllocator, valuePtr);
+                    m_valueAllocator.deallocate(valuePtr, 1);
+                });
+            }
+            m_root = nullptr;
+        }
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_root == nullptr;
+        }
+
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> value_type& {
+            auto* value = m_valueAllocator.allocate(1);
+            value_allocator_traits::construct(m_valueAllocator, value, std::forward<Args>(args)...);
+
+            const auto& lower = m_endpoints.lower(*value);
+            const auto& upper = m_endpoints.upper(*value);
+
+            // Subtree maxima only grow on insert, so they are raised on the way down
+            bnode* parent = nullptr;
+            auto** node = &m_root;
+            while (*node) {
+                parent = *node;
+                if (m_comparator(parent->max, upper)) {
+                    parent->max = upper;
+                }
+                node = m_comparator(lower, m_endpoints.lower(parent->value)) ? &parent->positive : &parent->negative;
+            }
+
+            *node = m_nodeAllocator.allocate(1);
+            node_allocator_traits::construct(m_nodeAllocator, *node, parent, nullptr, nullptr, *value, upper);
+            return *value;
+        }
+
+        constexpr auto& insert(const value_type& value) noexcept {
+            return emplace(value); // Calls copy constructor
+        }
+
+        constexpr auto& insert(value_type&& value) noexcept {
+            return emplace(std::move(value)); // Calls move constructor
+        }
+
+        /**
+         * Calls fn with every interval overlapping [lower, upper), in order of lower endpoint
+         */
+        template <typename K, class Fn>
+        constexpr void for_each_overlap(const K& lower, const K& upper, Fn fn) const noexcept {
+            enum class step { descend, visit, ascend };
+
+            auto* node = m_root;
+            auto state = step::descend;
+            while (node) {
+                if (state == step::descend) {
+                    if (!m_comparator(lower, node->max)) {
+                        state = step::ascend; // Nothing below ends after lower
+                    } else if (node->positive) {
+                        node = node->positive;
+                        continue;
+                    } else {
+                        state = step::visit;
+                    }
+                }
+
+                if (state == step::visit) {
+                    state = step::ascend;
+                    if (m_comparator(m_endpoints.lower(node->value), upper)) {
+                        if (m_comparator(lower, m_endpoints.upper(node->value))) {
+                            fn(node->value);
+                        }
+                        if (node->negative) {
+                            node = node->negative;
+                            state = step::descend;
+                            continue;
+                        }
+                    } // Otherwise everything on the negative side starts at or after upper
+                }
+
+                auto* parent = node->parent;
+                if (parent && parent->positive == node) {
+                    state = step::visit;
+                }
+                node = parent;
+            }
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto count_overlaps(const K& lower, const K& upper) const noexcept {
+            auto count = size_type{};
+            for_each_overlap(lower, upper, [&count](const value_type&) {
+                ++count;
+            });
+            return count;
+        }
+    private:
+        Allocator m_valueAllocator{};
+        node_allocator m_nodeAllocator{};
+        [[no_unique_address]] Endpoints m_endpoints;
+        Compare m_comparator;
+        bnode* m_root{};
+    };
+
+}
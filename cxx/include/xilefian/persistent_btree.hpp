@@ -0,0 +1,293 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace xilefian {
+
+    /**
+     * Unbalanced binary tree where every emplace copies the root-to-leaf path and leaves the previous version intact.
+     * A single writer calls emplace, any number of threads may call snapshot() and read the returned version freely.
+     * Nodes are shared between versions and reclaimed through reference counts.
+     */
+    template <typename T, class Compare = std::less<T>, class Allocator = std::allocator<T>>
+    class persistent_btree {
+    public:
+        using value_type = T;
+        using size_type = std::size_t;
+    private:
+        struct pnode {
+            std::atomic<size_type> references;
+            pnode* positive;
+            pnode* negative;
+            value_type value;
+
+            template <typename... Args>
+            pnode(pnode* positive, pnode* negative, Args&&... args) noexcept : references{1}, positive{positive}, negative{negative}, value(std::forward<Args>(args)...) {}
+
+            [[nodiscard]]
+            auto*& child(bool which) noexcept {
+                return which ? positive : negative;
+            }
+        };
+
+        using value_allocator_traits = std::allocator_traits<Allocator>;
+        using node_allocator = value_allocator_traits::template rebind_alloc<pnode>;
+        using node_allocator_traits = std::allocator_traits<node_allocator>;
+        using stack_allocator = value_allocator_traits::template rebind_alloc<const pnode*>;
+        using dead_allocator = value_allocator_traits::template rebind_alloc<pnode*>;
+
+        static pnode* acquire(pnode* node) noexcept {
+            if (node) {
+                node->references.fetch_add(1, std::memory_order_relaxed);
+            }
+            return node;
+        }
+
+        static void release(node_allocator& allocator, pnode* node) noexcept {
+            if (!node || node->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+                return;
+            }
+
+            // Iterative so that degenerate versions cannot exhaust the stack
+            std::vector<pnode*, dead_allocator> dead{dead_allocator{allocator}};
+            dead.push_back(node);
+            while (!dead.empty()) {
+                node = dead.back();
+                dead.pop_back();
+                for (auto* child : {node->positive, node->negative}) {
+                    if (child && child->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        dead.push_back(child);
+                    }
+                }
+                node_allocator_traits::destroy(allocator, node);
+                allocator.deallocate(node, 1);
+            }
+        }
+    public:
+        class view;
+
+        constexpr explicit persistent_btree(const Allocator allocator = Allocator()) noexcept : m_nodeAllocator{allocator} {}
+
+        persistent_btree(const persistent_btree&) = delete;
+        persistent_btree& operator=(const persistent_btree&) = delete;
+
+        ~persistent_btree() noexcept {
+            release(m_nodeAllocator, m_root.load(std::memory_order_relaxed));
+        }
+
+        [[nodiscard]]
+        auto empty() const noexcept {
+            return m_root.load(std::memory_order_relaxed) == nullptr;
+        }
+
+        /**
+         * Publishes a new version containing the value, copying only the nodes along the search path
+         */
+        template <typename... Args>
+        void emplace(Args&&... args) noexcept {
+            auto* leaf = m_nodeAllocator.allocate(1);
+            node_allocator_traits::construct(m_nodeAllocator, leaf, nullptr, nullptr, std::forward<Args>(args)...);
+
+            auto* current = m_root.load(std::memory_order_relaxed);
+            pnode* root = leaf;
+            auto** slot = &root;
+            for (auto* node = current; node; ) {
+                const auto which = m_comparator(leaf->value, node->value);
+
+                auto* copy = m_nodeAllocator.allocate(1);
+                node_allocator_traits::construct(m_nodeAllocator, copy, which ? nullptr : acquire(node->positive), which ? acquire(node->negative) : nullptr, node->value);
+                *slot = copy;
+                slot = &copy->child(which);
+                node = node->child(which);
+            }
+            *slot = leaf;
+
+            lock();
+            m_root.store(root, std::memory_order_relaxed);
+            unlock();
+
+            release(m_nodeAllocator, current);
+        }
+
+        void insert(const value_type& value) noexcept {
+            emplace(value); // Calls copy constructor
+        }
+
+        void insert(value_type&& value) noexcept {
+            emplace(std::move(value)); // Calls move constructor
+        }
+
+        /**
+         * Takes a reference to the current version. Safe to call concurrently with emplace
+         */
+        [[nodiscard]]
+        auto snapshot() const noexcept -> view {
+            lock();
+            auto* root = acquire(m_root.load(std::memory_order_relaxed));
+            unlock();
+            return view{root, m_nodeAllocator, m_comparator};
+        }
+
+        /**
+         * Immutable point-in-time view of the tree. Keeps its version alive until destroyed
+         */
+        class view {
+        public:
+            view(const view& other) noexcept : m_root{acquire(other.m_root)}, m_nodeAllocator{other.m_nodeAllocator}, m_comparator{other.m_comparator} {}
+
+            view(view&& other) noexcept : m_root{std::exchange(other.m_root, nullptr)}, m_nodeAllocator{other.m_nodeAllocator}, m_comparator{other.m_comparator} {}
+
+            view& operator=(view other) noexcept {
+                std::swap(m_root, other.m_root);
+                std::swap(m_nodeAllocator, other.m_nodeAllocator);
+                std::swap(m_comparator, other.m_comparator);
+                return *this;
+            }
+
+            ~view() noexcept {
+                release(m_nodeAllocator, m_root);
+            }
+
+            [[nodiscard]]
+            auto empty() const noexcept {
+                return m_root == nullptr;
+            }
+
+            class iterator {
+            public:
+                using difference_type = std::ptrdiff_t;
+                using value_type = T;
+                using pointer = const T*;
+                using reference = const T&;
+                using iterator_category = std::forward_iterator_tag;
+
+                auto& operator*() const noexcept {
+                    return m_stack.back()->value;
+                }
+
+                auto* operator->() const noexcept {
+                    return &m_stack.back()->value;
+                }
+
+                auto& operator++() noexcept {
+                    const auto* node = m_stack.back()->negative;
+                    m_stack.pop_back();
+                    push_leftmost(node);
+                    return *this;
+                }
+
+                auto operator++(int) noexcept -> iterator {
+                    auto copy = *this;
+                    ++*this;
+                    return copy;
+                }
+
+                bool operator==(const iterator& rhs) const noexcept {
+                    if (m_stack.empty() || rhs.m_stack.empty()) {
+                        return m_stack.empty() == rhs.m_stack.empty();
+                    }
+                    return m_stack.back() == rhs.m_stack.back();
+                }
+
+                bool operator!=(const iterator& rhs) const noexcept {
+                    return !(*this == rhs);
+                }
+            private:
+                friend class view;
+
+                explicit iterator(const stack_allocator& allocator) noexcept : m_stack{allocator} {}
+
+                void push_leftmost(const pnode* node) noexcept {
+                    while (node) {
+                        m_stack.push_back(node);
+                        node = node->positive;
+                    }
+                }
+
+                // Ancestors still to be visited, current node on top
+                std::vector<const pnode*, stack_allocator> m_stack;
+            };
+
+            auto begin() const noexcept -> iterator {
+                iterator it{stack_allocator{m_nodeAllocator}};
+                it.push_leftmost(m_root);
+                return it;
+            }
+
+            auto end() const noexcept -> iterator {
+                return iterator{stack_allocator{m_nodeAllocator}};
+            }
+
+            template <typename K>
+            [[nodiscard]]
+            auto lower_bound(const K& key) const noexcept -> iterator {
+                iterator it{stack_allocator{m_nodeAllocator}};
+                for (const auto* node = m_root; node; ) {
+                    if (m_comparator(node->value, key)) {
+                        node = node->negative;
+                    } else {
+                        it.m_stack.push_back(node);
+                        node = node->positive;
+                    }
+                }
+                return it;
+            }
+
+            template <typename K>
+            [[nodiscard]]
+            auto find(const K& key) const noexcept -> iterator {
+                auto it = lower_bound(key);
+                if (it != end() && m_comparator(key, *it)) {
+                    return end();
+                }
+                return it;
+            }
+
+            template <typename K>
+            [[nodiscard]]
+            bool contains(const K& key) const noexcept {
+                return find(key) != end();
+            }
+        private:
+            friend class persistent_btree;
+
+            view(pnode* root, const node_allocator& allocator, const Compare& comparator) noexcept : m_root{root}, m_nodeAllocator{allocator}, m_comparator{comparator} {}
+
+            pnode* m_root;
+            node_allocator m_nodeAllocator;
+            Compare m_comparator;
+        };
+    private:
+        // Only guards the load-and-acquire of the root against its replacement, never held while reading the tree
+        void lock() const noexcept {
+            while (m_publishing.test_and_set(std::memory_order_acquire)) {
+                m_publishing.wait(true, std::memory_order_relaxed);
+            }
+        }
+
+        void unlock() const noexcept {
+            m_publishing.clear(std::memory_order_release);
+            m_publishing.notify_one();
+        }
+
+        node_allocator m_nodeAllocator{};
+        Compare m_comparator;
+        std::atomic<pnode*> m_root{};
+        mutable std::atomic_flag m_publishing{};
+    };
+
+}
@@ -0,0 +1,161 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace xilefian {
+
+    /**
+     * Monotone min-priority queue for integer keys: a pushed key must not be less than the key last seen through front() or pop()
+     * Bucket b holds the keys whose highest bit differing from that last key is bit b - 1, bucket 0 holds keys equal to it
+     * Emptying bucket 0 redistributes the next occupied bucket into lower ones, so each value moves at most once per key bit
+     * No comparator is involved, keys are ordered by their bits
+     */
+    template <std::integral Key, typename Value, class Allocator = std::allocator<std::pair<Key, Value>>>
+    class radix_heap {
+    public:
+        using key_type = Key;
+        using mapped_type = Value;
+        using value_type = std::pair<Key, Value>;
+        using size_type = std::size_t;
+        using reference = value_type&;
+        using const_reference = const value_type&;
+        using allocator_type = Allocator;
+    private:
+        using bits_type = std::make_unsigned_t<Key>;
+        using bucket_type = std::vector<value_type, Allocator>;
+
+        static constexpr auto bucket_count = static_cast<size_type>(std::numeric_limits<bits_type>::digits) + 1;
+    public:
+        constexpr explicit radix_heap(const Allocator& allocator = Allocator()) noexcept {
+            for (auto& bucket : m_buckets) {
+                bucket = bucket_type(allocator);
+            }
+        }
+
+        [[nodiscard]]
+        constexpr bool empty() const noexcept {
+            return m_size == 0;
+        }
+
+        [[nodiscard]]
+        constexpr size_type size() const noexcept {
+            return m_size;
+        }
+
+        /**
+         * Smallest key and its value. Keys pushed afterwards must not be less than this key
+         * Not const, as finding the smallest key may redistribute the buckets
+         */
+        constexpr reference front() noexcept {
+            pull();
+            return m_buckets[0].back();
+        }
+
+        template <typename... Args>
+        constexpr void emplace(Args&&... args) noexcept {
+            value_type value(std::forward<Args>(args)...);
+            m_buckets[bucket_index(value.first)].push_back(std::move(value));
+            ++m_size;
+        }
+
+        constexpr void push(const value_type& value) noexcept {
+            m_buckets[bucket_index(value.first)].push_back(value);
+            ++m_size;
+        }
+
+        constexpr void push(value_type&& value) noexcept {
+            m_buckets[bucket_index(value.first)].push_back(std::move(value));
+            ++m_size;
+        }
+
+        constexpr void pop() noexcept {
+            pull();
+            m_buckets[0].pop_back();
+            --m_size;
+        }
+
+        constexpr void clear() noexcept {
+            for (auto& bucket : m_buckets) {
+                bucket.clear();
+            }
+            m_size = 0;
+            m_last = 0;
+        }
+
+        constexpr void swap(radix_heap& other) noexcept {
+            std::swap(m_buckets, other.m_buckets);
+            std::swap(m_size, other.m_size);
+            std::swap(m_last, other.m_last);
+        }
+    private:
+        // Flips the sign bit so that signed keys order the same as their bits
+        static constexpr auto to_bits(key_type key) noexcept -> bits_type {
+            if constexpr (std::is_signed_v<key_type>) {
+                return static_cast<bits_type>(key) ^ (static_cast<bits_type>(1) << (std::numeric_limits<bits_type>::digits - 1));
+            } else {
+                return key;
+            }
+        }
+
+        constexpr auto bucket_index(key_type key) const noexcept -> size_type {
+            return static_cast<size_type>(std::bit_width(static_cast<bits_type>(to_bits(key) ^ m_last)));
+        }
+
+        // Refills bucket 0 from the lowest occupied bucket, whose minimum becomes the new last key
+        constexpr void pull() noexcept {
+            if (!m_buckets[0].empty()) {
+                return;
+            }
+
+            auto index = static_cast<size_type>(1);
+            while (m_buckets[index].empty()) {
+                ++index;
+            }
+
+            auto& bucket = m_buckets[index];
+            auto minimum = to_bits(bucket.front().first);
+            for (const auto& value : bucket) {
+                const auto bits = to_bits(value.first);
+                minimum = bits < minimum ? bits : minimum;
+            }
+            m_last = minimum;
+
+            // Every value shares its bits above index - 1 with the minimum, so each lands in a lower bucket
+            for (auto& value : bucket) {
+                m_buckets[bucket_index(value.first)].push_back(std::move(value));
+            }
+            bucket.clear();
+        }
+
+        std::array<bucket_type, bucket_count> m_buckets;
+        bits_type m_last{};
+        size_type m_size{};
+    };
+
+}
+
+namespace std {
+
+    template <std::integral Key, typename Value, class Allocator>
+    constexpr void swap(xilefian::radix_heap<Key, Value, Allocator>& lhs, xilefian::radix_heap<Key, Value, Allocator>& rhs) noexcept {
+        lhs.swap(rhs);
+    }
+
+}
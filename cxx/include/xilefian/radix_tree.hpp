@@ -0,0 +1,936 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace xilefian {
+
+    /**
+     * Encodes keys as byte strings whose lexicographic order matches key order
+     * No encoding may be a prefix of another
+     */
+    template <typename Key>
+    struct radix_key_traits;
+
+    template <std::integral Key>
+    struct radix_key_traits<Key> {
+        // Big-endian with the sign bit flipped, so negative values sort first
+        static constexpr auto encode(Key key) noexcept -> std::array<std::uint8_t, sizeof(Key)> {
+            using unsigned_type = std::make_unsigned_t<Key>;
+
+            auto bits = static_cast<unsigned_type>(key);
+            if constexpr (std::is_signed_v<Key>) {
+                bits ^= static_cast<unsigned_type>(unsigned_type{1} << (sizeof(Key) * 8 - 1));
+            }
+
+            std::array<std::uint8_t, sizeof(Key)> bytes{};
+            for (auto ii = sizeof(Key); ii--; ) {
+                bytes[ii] = static_cast<std::uint8_t>(bits & 0xffu);
+                bits = static_cast<unsigned_type>(bits >> 4 >> 4);
+            }
+            return bytes;
+        }
+    };
+
+    template <>
+    struct radix_key_traits<std::string> {
+        // 00 is escaped as 00 FF and the key ends with 00 00
+        static constexpr auto encode(std::string_view key) noexcept -> std::string {
+            std::string bytes;
+            bytes.reserve(key.size() + 2);
+            for (const auto c : key) {
+                bytes.push_back(c);
+                if (c == '\0') {
+                    bytes.push_back('\xff');
+                }
+            }
+            bytes.append(2, '\0');
+            return bytes;
+        }
+    };
+
+    template <typename Key, class Traits>
+    concept radix_encodable = requires (const Key& key) {
+        { std::size(Traits::encode(key)) } -> std::convertible_to<std::size_t>;
+        { Traits::encode(key)[0] } -> std::convertible_to<std::uint8_t>;
+    };
+
+    /**
+     * Adaptive radix tree (Leis et al.) over the byte encoding of Key, holding each key at most once.
+     * Inner nodes hold 4, 16, 48 or 256 children and grow as needed, chains of single children are collapsed into prefixes.
+     * Lookups cost O(encoded key length) with no key comparisons on the way down.
+     * Leaves are threaded in key order, so iteration and iterator stability do not depend on the node layout.
+     */
+    template <typename Key, class Traits = radix_key_traits<Key>, class Allocator = std::allocator<Key>> requires radix_encodable<Key, Traits>
+    class radix_tree {
+    public:
+        using value_type = Key;
+        using size_type = std::size_t;
+    private:
+        using value_allocator_traits = std::allocator_traits<Allocator>;
+
+        static constexpr auto max_prefix = static_cast<std::uint32_t>(8);
+
+        enum class kind : std::uint8_t { leaf, node4, node16, node48, node256 };
+
+        struct rnode {
+            kind type;
+        };
+
+        struct rleaf : rnode {
+            template <typename... Args>
+            constexpr explicit rleaf(Args&&... args) noexcept : rnode{kind::leaf}, value(std::forward<Args>(args)...) {}
+
+            rleaf* prev{};
+            rleaf* next{};
+            value_type value;
+        };
+
+        // Prefix bytes past max_prefix are not stored, they are read back from a leaf below
+        struct rinner : rnode {
+            std::uint16_t count;
+            std::uint32_t prefixLength;
+            std::uint8_t prefix[max_prefix];
+        };
+
+        struct rnode4 : rinner {
+            std::uint8_t keys[4];
+            rnode* children[4];
+        };
+
+        struct rnode16 : rinner {
+            std::uint8_t keys[16];
+            rnode* children[16];
+        };
+
+        struct rnode48 : rinner {
+            std::uint8_t index[256]; // Child position + 1, 0 when absent
+            rnode* children[48];
+        };
+
+        struct rnode256 : rinner {
+            rnode* children[256];
+        };
+
+        template <class Node>
+        using node_allocator = value_allocator_traits::template rebind_alloc<Node>;
+
+        template <class Node>
+        using node_allocator_traits = std::allocator_traits<node_allocator<Node>>;
+    public:
+        constexpr explicit radix_tree(const Allocator allocator = Allocator()) noexcept : m_valueAllocator{allocator} {}
+
+        radix_tree(const radix_tree&) = delete;
+        radix_tree& operator=(const radix_tree&) = delete;
+
+        constexpr radix_tree(radix_tree&& other) noexcept : m_valueAllocator{other.m_valueAllocator}, m_root{std::exchange(other.m_root, nullptr)}, m_first{std::exchange(other.m_first, nullptr)}, m_last{std::exchange(other.m_last, nullptr)}, m_size{std::exchange(other.m_size, 0)} {}
+
+        constexpr radix_tree& operator=(radix_tree&& other) noexcept {
+            if (this != &other) {
+                clear();
+                m_valueAllocator = other.m_valueAllocator;
+                m_root = std::exchange(other.m_root, nullptr);
+                m_first = std::exchange(other.m_first, nullptr);
+                m_last = std::exchange(other.m_last, nullptr);
+                m_size = std::exchange(other.m_size, 0);
+            }
+            return *this;
+        }
+
+        constexpr ~radix_tree() noexcept {
+            clear();
+        }
+
+        constexpr void clear() noexcept {
+            if (m_root && m_root->type != kind::leaf) {
+                std::vector<rinner*, node_allocator<rinner*>> pending{node_allocator<rinner*>{m_valueAllocator}};
+                pending.push_back(static_cast<rinner*>(m_root));
+                while (!pending.empty()) {
+                    auto* node = pending.back();
+                    pending.pop_back();
+                    for_each_child(node, [&pending](rnode* child) {
+                        if (child->type != kind::leaf) {
+                            pending.push_back(static_cast<rinner*>(child));
+                        }
+                    });
+                    free_inner(node);
+                }
+            }
+
+            for (auto* leaf = m_first; leaf; ) {
+                free_node(std::exchange(leaf, leaf->next));
+            }
+
+            m_root = nullptr;
+            m_first = nullptr;
+            m_last = nullptr;
+            m_size = 0;
+        }
+
+        [[nodiscard]]
+        constexpr auto empty() const noexcept {
+            return m_size == 0;
+        }
+
+        [[nodiscard]]
+        constexpr auto size() const noexcept {
+            return m_size;
+        }
+
+        class iterator {
+        public:
+            using difference_type = std::ptrdiff_t;
+            using value_type = Key;
+            using pointer = const Key*;
+            using reference = const Key&;
+            using iterator_category = std::bidirectional_iterator_tag;
+
+            constexpr iterator() noexcept = default;
+
+            constexpr auto& operator*() const noexcept {
+                return m_leaf->value;
+            }
+
+            constexpr auto* operator->() const noexcept {
+                return &m_leaf->value;
+            }
+
+            constexpr auto& operator++() noexcept {
+                m_leaf = m_leaf->next;
+                return *this;
+            }
+
+            constexpr auto operator++(int) noexcept -> iterator {
+                auto copy = *this;
+                m_leaf = m_leaf->next;
+                return copy;
+            }
+
+            constexpr auto& operator--() noexcept {
+                m_leaf = m_leaf ? m_leaf->prev : m_owner->m_last;
+                return *this;
+            }
+
+            constexpr auto operator--(int) noexcept -> iterator {
+                auto copy = *this;
+                --*this;
+                return copy;
+            }
+
+            constexpr bool operator==(const iterator& rhs) const noexcept {
+                return m_leaf == rhs.m_leaf;
+            }
+
+            constexpr bool operator!=(const iterator& rhs) const noexcept {
+                return m_leaf != rhs.m_leaf;
+            }
+        private:
+            friend class radix_tree;
+
+            constexpr iterator(const radix_tree* owner, rleaf* leaf) noexcept : m_owner{owner}, m_leaf{leaf} {}
+
+            const radix_tree* m_owner{};
+            rleaf* m_leaf{};
+        };
+
+        /**
+         * Inserts a key constructed from args, unless an equal key is already present
+         */
+        template <typename... Args>
+        constexpr auto emplace(Args&&... args) noexcept -> std::pair<iterator, bool> {
+            auto* leaf = make_node<rleaf>(std::forward<Args>(args)...);
+            const auto [found, inserted] = insert_leaf(leaf);
+            if (!inserted) {
+                free_node(leaf);
+            }
+            return {iterator{this, found}, inserted};
+        }
+
+        /**
+         * Descent does not depend on neighbouring keys, so the hint is only accepted for parity with btree
+         */
+        template <typename... Args>
+        constexpr auto emplace_hint(iterator, Args&&... args) noexcept -> iterator {
+            return emplace(std::forward<Args>(args)...).first;
+        }
+
+        constexpr auto insert(const value_type& value) noexcept {
+            return emplace(value); // Calls copy constructor
+        }
+
+        constexpr auto insert(value_type&& value) noexcept {
+            return emplace(std::move(value)); // Calls move constructor
+        }
+
+        /**
+         * Removes the key at pos, returning the iterator after it
+         * Nodes shrink as they empty, and a node4 left with one child is merged into it
+         */
+        constexpr auto erase(iterator pos) noexcept -> iterator {
+            auto* leaf = pos.m_leaf;
+            auto* next = leaf->next;
+            remove_leaf(leaf);
+            return iterator{this, next};
+        }
+
+        template <typename K>
+        constexpr auto erase(const K& key) noexcept -> size_type {
+            const auto found = find(key);
+            if (found == end()) {
+                return 0;
+            }
+            remove_leaf(found.m_leaf);
+            return 1;
+        }
+
+        constexpr auto begin() noexcept -> iterator {
+            return iterator{this, m_first};
+        }
+
+        constexpr auto end() noexcept -> iterator {
+            return iterator{this, nullptr};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto lower_bound(const K& key) noexcept -> iterator {
+            return iterator{this, lower_leaf(Traits::encode(key))};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto upper_bound(const K& key) noexcept -> iterator {
+            const auto bytes = Traits::encode(key);
+            auto* leaf = lower_leaf(bytes);
+            if (leaf && compare(Traits::encode(leaf->value), bytes) == 0) {
+                leaf = leaf->next;
+            }
+            return iterator{this, leaf};
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr auto find(const K& key) noexcept -> iterator {
+            const auto bytes = Traits::encode(key);
+            const auto keySize = std::size(bytes);
+
+            // Only stored prefix bytes are checked on the way down, the leaf settles the rest
+            auto* node = m_root;
+            size_type depth = 0;
+            while (node && node->type != kind::leaf) {
+                const auto* inner = static_cast<const rinner*>(node);
+                const auto stored = std::min(inner->prefixLength, max_prefix);
+                for (std::uint32_t ii = 0; ii < stored; ++ii) {
+                    if (depth + ii >= keySize || inner->prefix[ii] != byte_at(bytes, depth + ii)) {
+                        return end();
+                    }
+                }
+
+                depth += inner->prefixLength;
+                if (depth >= keySize) {
+                    return end();
+                }
+
+                auto** child = find_child(node, byte_at(bytes, depth++));
+                node = child ? *child : nullptr;
+            }
+
+            if (node && compare(Traits::encode(static_cast<rleaf*>(node)->value), bytes) == 0) {
+                return iterator{this, static_cast<rleaf*>(node)};
+            }
+            return end();
+        }
+
+        template <typename K>
+        [[nodiscard]]
+        constexpr bool contains(const K& key) noexcept {
+            return find(key) != end();
+        }
+    private:
+        template <class Bytes>
+        static constexpr auto byte_at(const Bytes& bytes, size_type index) noexcept {
+            return static_cast<std::uint8_t>(bytes[index]);
+        }
+
+        template <class Lhs, class Rhs>
+        static constexpr auto compare(const Lhs& lhs, const Rhs& rhs) noexcept -> int {
+            const auto length = std::min<size_type>(std::size(lhs), std::size(rhs));
+            for (size_type ii = 0; ii < length; ++ii) {
+                if (byte_at(lhs, ii) != byte_at(rhs, ii)) {
+                    return byte_at(lhs, ii) < byte_at(rhs, ii) ? -1 : 1;
+                }
+            }
+            return std::size(lhs) < std::size(rhs) ? -1 : std::size(lhs) > std::size(rhs) ? 1 : 0;
+        }
+
+        template <class Node, typename... Args>
+        constexpr auto* make_node(Args&&... args) noexcept {
+            node_allocator<Node> allocator{m_valueAllocator};
+            auto* node = allocator.allocate(1);
+            node_allocator_traits<Node>::construct(allocator, node, std::forward<Args>(args)...);
+            return node;
+        }
+
+        template <class Node>
+        constexpr void free_node(Node* node) noexcept {
+            node_allocator<Node> allocator{m_valueAllocator};
+            node_allocator_traits<Node>::destroy(allocator, node);
+            allocator.deallocate(node, 1);
+        }
+
+        template <class Node>
+        constexpr auto* make_inner(kind type, const rinner* header = nullptr) noexcept {
+            auto* node = make_node<Node>();
+            node->type = type;
+            if (header) {
+                node->count = header->count;
+                node->prefixLength = header->prefixLength;
+                std::copy_n(header->prefix, max_prefix, node->prefix);
+            }
+            return node;
+        }
+
+        constexpr void free_inner(rinner* node) noexcept {
+            switch (node->type) {
+            case kind::node4:
+                return free_node(static_cast<rnode4*>(node));
+            case kind::node16:
+                return free_node(static_cast<rnode16*>(node));
+            case kind::node48:
+                return free_node(static_cast<rnode48*>(node));
+            default:
+                return free_node(static_cast<rnode256*>(node));
+            }
+        }
+
+        template <class Fn>
+        static constexpr void for_each_child(rinner* node, Fn fn) noexcept {
+            switch (node->type) {
+            case kind::node4:
+                std::for_each_n(static_cast<rnode4*>(node)->children, node->count, fn);
+                return;
+            case kind::node16:
+                std::for_each_n(static_cast<rnode16*>(node)->children, node->count, fn);
+                return;
+            case kind::node48:
+                std::for_each_n(static_cast<rnode48*>(node)->children, node->count, fn);
+                return;
+            default:
+                for (auto* child : static_cast<rnode256*>(node)->children) {
+                    if (child) {
+                        fn(child);
+                    }
+                }
+            }
+        }
+
+        // Slot holding the child for byte, nullptr when absent
+        static constexpr auto find_child(rnode* node, std::uint8_t byte) noexcept -> rnode** {
+            switch (node->type) {
+            case kind::node4: {
+                auto* n = static_cast<rnode4*>(node);
+                for (std::uint16_t ii = 0; ii < n->count; ++ii) {
+                    if (n->keys[ii] == byte) {
+                        return &n->children[ii];
+                    }
+                }
+                return nullptr;
+            }
+            case kind::node16: {
+                auto* n = static_cast<rnode16*>(node);
+#if defined(__SSE2__)
+                if (!std::is_constant_evaluated()) {
+                    const auto keys = _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys));
+                    const auto matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)), keys);
+                    const auto mask = static_cast<unsigned>(_mm_movemask_epi8(matches)) & ((1u << n->count) - 1u);
+                    return mask ? &n->children[std::countr_zero(mask)] : nullptr;
+                }
+#endif
+                for (std::uint16_t ii = 0; ii < n->count; ++ii) {
+                    if (n->keys[ii] == byte) {
+                        return &n->children[ii];
+                    }
+                }
+                return nullptr;
+            }
+            case kind::node48: {
+                auto* n = static_cast<rnode48*>(node);
+                return n->index[byte] ? &n->children[n->index[byte] - 1] : nullptr;
+            }
+            default: {
+                auto* n = static_cast<rnode256*>(node);
+                return n->children[byte] ? &n->children[byte] : nullptr;
+            }
+            }
+        }
+
+        // Child with the smallest byte after the given one (-1 for the first child), nullptr when none
+        static constexpr auto next_child(rinner* node, int after) noexcept -> rnode* {
+            const auto sorted = [&](const std::uint8_t* keys, rnode* const* children) -> rnode* {
+                for (std::uint16_t ii = 0; ii < node->count; ++ii) {
+                    if (keys[ii] > after) {
+                        return children[ii];
+                    }
+                }
+                return nullptr;
+            };
+
+            switch (node->type) {
+            case kind::node4:
+                return sorted(static_cast<rnode4*>(node)->keys, static_cast<rnode4*>(node)->children);
+            case kind::node16:
+                return sorted(static_cast<rnode16*>(node)->keys, static_cast<rnode16*>(node)->children);
+            case kind::node48: {
+                auto* n = static_cast<rnode48*>(node);
+                for (auto byte = after + 1; byte < 256; ++byte) {
+                    if (n->index[byte]) {
+                        return n->children[n->index[byte] - 1];
+                    }
+                }
+                return nullptr;
+            }
+            default: {
+                auto* n = static_cast<rnode256*>(node);
+                for (auto byte = after + 1; byte < 256; ++byte) {
+                    if (n->children[byte]) {
+                        return n->children[byte];
+                    }
+                }
+                return nullptr;
+            }
+            }
+        }
+
+        static constexpr auto last_child(rinner* node) noexcept -> rnode* {
+            switch (node->type) {
+            case kind::node4:
+                return static_cast<rnode4*>(node)->children[node->count - 1];
+            case kind::node16:
+                return static_cast<rnode16*>(node)->children[node->count - 1];
+            case kind::node48: {
+                auto* n = static_cast<rnode48*>(node);
+                auto byte = 256;
+                while (!n->index[--byte]) {}
+                return n->children[n->index[byte] - 1];
+            }
+            default: {
+                auto* n = static_cast<rnode256*>(node);
+                auto byte = 256;
+                while (!n->children[--byte]) {}
+                return n->children[byte];
+            }
+            }
+        }
+
+        static constexpr auto* minimum(rnode* node) noexcept {
+            while (node->type != kind::leaf) {
+                node = next_child(static_cast<rinner*>(node), -1);
+            }
+            return static_cast<rleaf*>(node);
+        }
+
+        static constexpr auto* maximum(rnode* node) noexcept {
+            while (node->type != kind::leaf) {
+                node = last_child(static_cast<rinner*>(node));
+            }
+            return static_cast<rleaf*>(node);
+        }
+
+        template <class Node>
+        static constexpr void insert_sorted(Node* node, std::uint8_t byte, rnode* child) noexcept {
+            auto position = node->count;
+            while (position && node->keys[position - 1] > byte) {
+                node->keys[position] = node->keys[position - 1];
+                node->children[position] = node->children[position - 1];
+                --position;
+            }
+            node->keys[position] = byte;
+            node->children[position] = child;
+            ++node->count;
+        }
+
+        // Adds child under byte, replacing *slot with a larger node when full
+        constexpr void add_child(rnode** slot, std::uint8_t byte, rnode* child) noexcept {
+            switch ((*slot)->type) {
+            case kind::node4: {
+                auto* n = static_cast<rnode4*>(*slot);
+                if (n->count < 4) {
+                    return insert_sorted(n, byte, child);
+                }
+                auto* grown = make_inner<rnode16>(kind::node16, n);
+                std::copy_n(n->keys, 4, grown->keys);
+                std::copy_n(n->children, 4, grown->children);
+                free_node(n);
+                *slot = grown;
+                return insert_sorted(grown, byte, child);
+            }
+            case kind::node16: {
+                auto* n = static_cast<rnode16*>(*slot);
+                if (n->count < 16) {
+                    return insert_sorted(n, byte, child);
+                }
+                auto* grown = make_inner<rnode48>(kind::node48, n);
+                for (std::uint16_t ii = 0; ii < 16; ++ii) {
+                    grown->index[n->keys[ii]] = static_cast<std::uint8_t>(ii + 1);
+                    grown->children[ii] = n->children[ii];
+                }
+                free_node(n);
+                *slot = grown;
+                grown->index[byte] = static_cast<std::uint8_t>(grown->count + 1);
+                grown->children[grown->count++] = child;
+                return;
+            }
+            case kind::node48: {
+                auto* n = static_cast<rnode48*>(*slot);
+                if (n->count < 48) {
+                    n->index[byte] = static_cast<std::uint8_t>(n->count + 1);
+                    n->children[n->count++] = child;
+                    return;
+                }
+                auto* grown = make_inner<rnode256>(kind::node256, n);
+                for (auto ii = 0; ii < 256; ++ii) {
+                    if (n->index[ii]) {
+                        grown->children[ii] = n->children[n->index[ii] - 1];
+                    }
+                }
+                free_node(n);
+                *slot = grown;
+                grown->children[byte] = child;
+                ++grown->count;
+                return;
+            }
+            default: {
+                auto* n = static_cast<rnode256*>(*slot);
+                n->children[byte] = child;
+                ++n->count;
+            }
+            }
+        }
+
+        template <class Node>
+        static constexpr void erase_sorted(Node* node, std::uint16_t position) noexcept {
+            --node->count;
+            std::copy(node->keys + position + 1, node->keys + node->count + 1, node->keys + position);
+            std::copy(node->children + position + 1, node->children + node->count + 1, node->children + position);
+        }
+
+        // Removes the child under byte, replacing *slot with a smaller node, or with its only child when one remains
+        constexpr void remove_child(rnode** slot, std::uint8_t byte) noexcept {
+            switch ((*slot)->type) {
+            case kind::node4: {
+                auto* n = static_cast<rnode4*>(*slot);
+                erase_sorted(n, static_cast<std::uint16_t>(find_child(n, byte) - n->children));
+                if (n->count == 1) {
+                    *slot = collapse(n);
+                }
+                return;
+            }
+            case kind::node16: {
+                auto* n = static_cast<rnode16*>(*slot);
+                erase_sorted(n, static_cast<std::uint16_t>(find_child(n, byte) - n->children));
+                if (n->count > 3) {
+                    return;
+                }
+                auto* shrunk = make_inner<rnode4>(kind::node4, n);
+                std::copy_n(n->keys, n->count, shrunk->keys);
+                std::copy_n(n->children, n->count, shrunk->children);
+                free_node(n);
+                *slot = shrunk;
+                return;
+            }
+            case kind::node48: {
+                auto* n = static_cast<rnode48*>(*slot);
+                const auto position = n->index[byte] - 1;
+                n->index[byte] = 0;
+
+                // The last child fills the hole, keeping children packed
+                if (position != --n->count) {
+                    n->children[position] = n->children[n->count];
+                    for (auto ii = 0; ii < 256; ++ii) {
+                        if (n->index[ii] == n->count + 1) {
+                            n->index[ii] = static_cast<std::uint8_t>(position + 1);
+                            break;
+                        }
+                    }
+                }
+                if (n->count > 12) {
+                    return;
+                }
+                auto* shrunk = make_inner<rnode16>(kind::node16, n);
+                shrunk->count = 0;
+                for (auto ii = 0; ii < 256; ++ii) {
+                    if (n->index[ii]) {
+                        shrunk->keys[shrunk->count] = static_cast<std::uint8_t>(ii);
+                        shrunk->children[shrunk->count++] = n->children[n->index[ii] - 1];
+                    }
+                }
+                free_node(n);
+                *slot = shrunk;
+                return;
+            }
+            default: {
+                auto* n = static_cast<rnode256*>(*slot);
+                n->children[byte] = nullptr;
+                if (--n->count > 37) {
+                    return;
+                }
+                auto* shrunk = make_inner<rnode48>(kind::node48, n);
+                shrunk->count = 0;
+                for (auto ii = 0; ii < 256; ++ii) {
+                    if (n->children[ii]) {
+                        shrunk->index[ii] = static_cast<std::uint8_t>(shrunk->count + 1);
+                        shrunk->children[shrunk->count++] = n->children[ii];
+                    }
+                }
+                free_node(n);
+                *slot = shrunk;
+            }
+            }
+        }
+
+        // Frees a node4 holding one child and returns that child, with the node4 prefix and key byte prepended to its own
+        constexpr auto collapse(rnode4* node) noexcept -> rnode* {
+            auto* child = node->children[0];
+            if (child->type != kind::leaf) {
+                auto* inner = static_cast<rinner*>(child);
+
+                // Bytes past max_prefix are read back from a leaf, so only the stored bytes need merging
+                std::uint8_t merged[max_prefix];
+                auto length = std::min(node->prefixLength, max_prefix);
+                std::copy_n(node->prefix, length, merged);
+                if (length < max_prefix) {
+                    merged[length++] = node->keys[0];
+                }
+                std::copy_n(inner->prefix, std::min(max_prefix - length, std::min(inner->prefixLength, max_prefix)), merged + length);
+
+                inner->prefixLength += node->prefixLength + 1;
+                std::copy_n(merged, max_prefix, inner->prefix);
+            }
+            free_node(node);
+            return child;
+        }
+
+        // Unthreads leaf, detaches it from its parent and frees it
+        constexpr void remove_leaf(rleaf* leaf) noexcept {
+            const auto key = Traits::encode(leaf->value);
+
+            rnode** parent = nullptr;
+            auto** slot = &m_root;
+            std::uint8_t byte = 0;
+            size_type depth = 0;
+            while (*slot != leaf) {
+                depth += static_cast<rinner*>(*slot)->prefixLength;
+                byte = byte_at(key, depth++);
+                parent = std::exchange(slot, find_child(*slot, byte));
+            }
+
+            if (parent) {
+                remove_child(parent, byte);
+            } else {
+                m_root = nullptr;
+            }
+
+            (leaf->prev ? leaf->prev->next : m_first) = leaf->next;
+            (leaf->next ? leaf->next->prev : m_last) = leaf->prev;
+            --m_size;
+            free_node(leaf);
+        }
+
+        template <class Bytes>
+        static constexpr void set_prefix(rinner* node, const Bytes& key, size_type depth, std::uint32_t length) noexcept {
+            node->prefixLength = length;
+            for (std::uint32_t ii = 0; ii < std::min(length, max_prefix); ++ii) {
+                node->prefix[ii] = byte_at(key, depth + ii);
+            }
+        }
+
+        // Byte at offset within node's prefix, which starts at depth
+        static constexpr auto prefix_byte(rinner* node, size_type depth, std::uint32_t offset) noexcept -> std::uint8_t {
+            if (offset < max_prefix) {
+                return node->prefix[offset];
+            }
+            return byte_at(Traits::encode(minimum(node)->value), depth + offset);
+        }
+
+        // Length of the run of node's prefix that matches key from depth
+        template <class Bytes>
+        static constexpr auto prefix_match(rinner* node, const Bytes& key, size_type depth) noexcept -> std::uint32_t {
+            const auto keySize = std::size(key);
+            const auto stored = std::min(node->prefixLength, max_prefix);
+
+            std::uint32_t ii = 0;
+            while (ii < stored && depth + ii < keySize && node->prefix[ii] == byte_at(key, depth + ii)) {
+                ++ii;
+            }
+            if (ii == stored && node->prefixLength > max_prefix) {
+                const auto leafKey = Traits::encode(minimum(node)->value);
+                while (ii < node->prefixLength && depth + ii < keySize && byte_at(leafKey, depth + ii) == byte_at(key, depth + ii)) {
+                    ++ii;
+                }
+            }
+            return ii;
+        }
+
+        // Removes the first count bytes of node's prefix, which starts at depth
+        static constexpr void drop_prefix(rinner* node, size_type depth, std::uint32_t count) noexcept {
+            const auto remaining = node->prefixLength - count;
+            if (node->prefixLength <= max_prefix) {
+                std::copy(node->prefix + count, node->prefix + node->prefixLength, node->prefix);
+            } else {
+                const auto leafKey = Traits::encode(minimum(node)->value);
+                for (std::uint32_t ii = 0; ii < std::min(remaining, max_prefix); ++ii) {
+                    node->prefix[ii] = byte_at(leafKey, depth + count + ii);
+                }
+            }
+            node->prefixLength = remaining;
+        }
+
+        // Threads leaf in before next, or at the back when next is nullptr
+        constexpr void link_leaf(rleaf* leaf, rleaf* next) noexcept {
+            leaf->next = next;
+            leaf->prev = next ? next->prev : m_last;
+            (leaf->prev ? leaf->prev->next : m_first) = leaf;
+            (next ? next->prev : m_last) = leaf;
+            ++m_size;
+        }
+
+        // Places existing and leaf under a new node4 at *slot, keyed by the first byte where they differ
+        template <class Bytes>
+        constexpr void branch(rnode** slot, rnode* existing, std::uint8_t existingByte, rleaf* leaf, const Bytes& key, std::uint32_t prefixLength, size_type depth) noexcept {
+            const auto leafByte = byte_at(key, depth + prefixLength);
+
+            rnode* split = make_inner<rnode4>(kind::node4);
+            set_prefix(static_cast<rinner*>(split), key, depth, prefixLength);
+            add_child(&split, existingByte, existing);
+            add_child(&split, leafByte, leaf);
+
+            link_leaf(leaf, leafByte < existingByte ? minimum(existing) : maximum(existing)->next);
+            *slot = split;
+        }
+
+        constexpr auto insert_leaf(rleaf* leaf) noexcept -> std::pair<rleaf*, bool> {
+            if (!m_root) {
+                m_root = leaf;
+                link_leaf(leaf, nullptr);
+                return {leaf, true};
+            }
+
+            const auto key = Traits::encode(leaf->value);
+            const auto keySize = std::size(key);
+
+            auto** slot = &m_root;
+            size_type depth = 0;
+            while (true) {
+                if ((*slot)->type == kind::leaf) {
+                    auto* existing = static_cast<rleaf*>(*slot);
+                    const auto other = Traits::encode(existing->value);
+                    const auto otherSize = std::size(other);
+
+                    auto common = depth;
+                    while (common < keySize && common < otherSize && byte_at(key, common) == byte_at(other, common)) {
+                        ++common;
+                    }
+                    if (common == keySize && common == otherSize) {
+                        return {existing, false};
+                    }
+
+                    // Prefix-free encodings differ at a byte both keys have
+                    branch(slot, existing, byte_at(other, common), leaf, key, static_cast<std::uint32_t>(common - depth), depth);
+                    return {leaf, true};
+                }
+
+                auto* inner = static_cast<rinner*>(*slot);
+                const auto matched = prefix_match(inner, key, depth);
+                if (matched < inner->prefixLength) {
+                    const auto innerByte = prefix_byte(inner, depth, matched);
+                    drop_prefix(inner, depth, matched + 1);
+                    branch(slot, inner, innerByte, leaf, key, matched, depth);
+                    return {leaf, true};
+                }
+
+                depth += inner->prefixLength;
+                const auto byte = byte_at(key, depth);
+                if (auto** child = find_child(inner, byte)) {
+                    slot = child;
+                    ++depth;
+                    continue;
+                }
+
+                auto* after = next_child(inner, byte);
+                auto* next = after ? minimum(after) : maximum(inner)->next;
+                add_child(slot, byte, leaf);
+                link_leaf(leaf, next);
+                return {leaf, true};
+            }
+        }
+
+        template <class Bytes>
+        constexpr auto lower_leaf(const Bytes& key) const noexcept -> rleaf* {
+            const auto keySize = std::size(key);
+
+            auto* node = m_root;
+            size_type depth = 0;
+            while (node) {
+                if (node->type == kind::leaf) {
+                    auto* leaf = static_cast<rleaf*>(node);
+                    return compare(Traits::encode(leaf->value), key) < 0 ? leaf->next : leaf;
+                }
+
+                auto* inner = static_cast<rinner*>(node);
+                const auto matched = prefix_match(inner, key, depth);
+                if (matched < inner->prefixLength) {
+                    // The whole subtree sorts on one side of key
+                    if (depth + matched >= keySize || byte_at(key, depth + matched) < prefix_byte(inner, depth, matched)) {
+                        return minimum(inner);
+                    }
+                    return maximum(inner)->next;
+                }
+
+                depth += inner->prefixLength;
+                if (depth >= keySize) {
+                    return minimum(inner);
+                }
+
+                const auto byte = byte_at(key, depth++);
+                if (auto** child = find_child(inner, byte)) {
+                    node = *child;
+                    continue;
+                }
+
+                auto* after = next_child(inner, byte);
+                return after ? minimum(after) : maximum(inner)->next;
+            }
+            return nullptr;
+        }
+
+        Allocator m_valueAllocator{};
+        rnode* m_root{};
+        rleaf* m_first{};
+        rleaf* m_last{};
+        size_type m_size{};
+    };
+
+}
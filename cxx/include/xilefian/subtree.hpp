@@ -0,0 +1,37 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#pragma once
+
+namespace xilefian::detail {
+
+    /**
+     * Calls destroy on node and every node below it, children first
+     * Walks post-order through parent, positive and negative links, constant stack regardless of shape
+     */
+    template <typename Node, class Destroy>
+    constexpr void destroy_subtree(Node* node, Destroy destroy) noexcept {
+        auto* const top = node->parent;
+        while (node != top) {
+            if (node->positive) {
+                node = node->positive;
+            } else if (node->negative) {
+                node = node->negative;
+            } else {
+                auto* parent = node->parent;
+                if (parent != top) {
+                    (parent->positive == node ? parent->positive : parent->negative) = nullptr;
+                }
+                destroy(node);
+                node = parent;
+            }
+        }
+    }
+
+}
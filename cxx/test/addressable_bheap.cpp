@@ -0,0 +1,138 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <xilefian/addressable_bheap.hpp>
+
+// Random pushes, pops, erases, decreases and updates through handles, checked against a std::multiset of live values
+template <std::size_t Arity>
+static void run() {
+    using heap_type = xilefian::addressable_bheap<int, std::greater<int>, Arity>;
+
+    std::mt19937 rng{73};
+
+    heap_type heap;
+    std::multiset<int> set;
+    std::vector<std::pair<typename heap_type::handle_type, int>> live;
+    std::vector<typename heap_type::handle_type> dead;
+
+    const auto remove = [&](std::size_t position) {
+        set.erase(set.find(live[position].second));
+        dead.push_back(live[position].first);
+        live[position] = live.back();
+        live.pop_back();
+    };
+
+    for (auto ii = 0; ii < 20000; ++ii) {
+        const auto value = static_cast<int>(rng() % 1000);
+        const auto position = live.empty() ? 0 : rng() % live.size();
+        switch (live.empty() ? 0 : rng() % 6) {
+        case 0: case 1:
+            live.emplace_back(heap.push(value), value);
+            set.insert(value);
+            break;
+        case 2: {
+            const auto front = heap.front_handle();
+            assert(heap[front] == *set.begin());
+            heap.pop();
+            const auto found = std::find_if(live.begin(), live.end(), [&front](const auto& entry) {
+                return entry.first == front;
+            });
+            assert(found != live.end());
+            remove(static_cast<std::size_t>(found - live.begin()));
+            break;
+        }
+        case 3:
+            heap.erase(live[position].first);
+            remove(position);
+            break;
+        case 4: {
+            auto& [handle, current] = live[position];
+            const auto lower = current - static_cast<int>(rng() % 100);
+            heap.decrease(handle, lower);
+            set.erase(set.find(current));
+            set.insert(lower);
+            current = lower;
+            break;
+        }
+        default: {
+            auto& [handle, current] = live[position];
+            heap[handle] = value;
+            heap.update(handle);
+            set.erase(set.find(current));
+            set.insert(value);
+            current = value;
+        }
+        }
+
+        assert(heap.size() == set.size());
+        assert(set.empty() || heap.front() == *set.begin());
+        if (!live.empty()) {
+            const auto& [handle, current] = live[rng() % live.size()];
+            assert(heap.contains(handle) && heap[handle] == current);
+        }
+        if (!dead.empty()) {
+            assert(!heap.contains(dead[rng() % dead.size()])); // Even once its slot is reused
+        }
+    }
+}
+
+int main() {
+    run<2>();
+    run<4>();
+
+    using heap_type = xilefian::addressable_bheap<int, std::greater<int>, 4>;
+
+    heap_type heap;
+    std::vector<heap_type::handle_type> handles;
+    for (auto ii = 0; ii < 100; ++ii) {
+        handles.push_back(heap.push(1000 + ii));
+    }
+
+    heap.decrease(handles[50], 5);
+    heap[handles[70]] = 7;
+    heap.update(handles[70]);
+    heap.erase(handles[60]);
+    assert(!heap.contains(handles[60]));
+
+    assert(heap.front() == 5 && heap.front_handle() == handles[50]);
+    heap.pop();
+    assert(heap.front() == 7);
+    heap.pop();
+
+    // A popped handle stays dead after its slot is reused
+    const auto stale = handles[50];
+    const auto fresh = heap.push(1);
+    assert(fresh.index == stale.index || fresh.index == handles[70].index);
+    assert(!heap.contains(stale) && !heap.contains(handles[70]));
+    assert(heap.contains(fresh) && heap[fresh] == 1);
+
+    auto previous = 0;
+    while (!heap.empty()) {
+        assert(heap.front() >= previous);
+        previous = heap.front();
+        heap.pop();
+    }
+
+    const auto beforeClear = heap.push(3);
+    heap.clear();
+    assert(!heap.contains(beforeClear));
+    const auto afterClear = heap.push(4);
+    assert(heap.contains(afterClear));
+    assert(!heap.contains(beforeClear));
+    return 0;
+}
@@ -0,0 +1,127 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include <xilefian/bheap.hpp>
+
+// Random pushes, range pushes and pops at several arities and both sift policies, checked against std::priority_queue
+
+template <class Heap>
+static void drain(Heap& heap, std::priority_queue<int>& queue) {
+    while (!queue.empty()) {
+        assert(heap.front() == queue.top());
+        heap.pop();
+        queue.pop();
+    }
+    assert(heap.empty());
+}
+
+template <std::size_t Arity, xilefian::bheap_sift Sift>
+static void run() {
+    using heap_type = xilefian::bheap<int, std::less<int>, std::vector<int>, Arity, Sift>;
+
+    std::mt19937 rng{71};
+
+    // Floyd construction from every source, sizes around the partial last sibling group
+    for (std::size_t n = 0; n < 100; ++n) {
+        std::vector<int> values(n);
+        for (auto& value : values) {
+            value = static_cast<int>(rng() % 50);
+        }
+
+        heap_type fromRange{values.begin(), values.end()};
+        heap_type fromCopy{values};
+        heap_type fromMove{std::vector<int>(values)};
+        for (auto* heap : {&fromRange, &fromCopy, &fromMove}) {
+            std::priority_queue<int> queue(values.begin(), values.end());
+            drain(*heap, queue);
+        }
+    }
+
+    heap_type heap;
+    std::priority_queue<int> queue;
+
+    for (auto ii = 0; ii < 20000; ++ii) {
+        if (rng() % 16 == 0) {
+            // Small ranges sift each value up, large ones relative to the heap rebuild it
+            std::vector<int> values(rng() % (rng() % 4 ? 8 : 400));
+            for (auto& value : values) {
+                value = static_cast<int>(rng() % 1000);
+            }
+            heap.push_range(values.begin(), values.end());
+            for (const auto value : values) {
+                queue.push(value);
+            }
+        } else if (queue.empty() || rng() % 5 < 3) {
+            const auto value = static_cast<int>(rng() % 1000); // Plenty of duplicates
+            if (rng() % 2) {
+                heap.push(value);
+            } else {
+                heap.emplace(value);
+            }
+            queue.push(value);
+        } else {
+            heap.pop();
+            queue.pop();
+        }
+
+        assert(heap.size() == queue.size());
+        assert(queue.empty() || heap.front() == queue.top());
+    }
+    drain(heap, queue);
+}
+
+struct counting_less {
+    std::size_t* count;
+
+    bool operator()(const int lhs, const int rhs) const noexcept {
+        ++*count;
+        return lhs < rhs;
+    }
+};
+
+// Comparisons made by draining a heap of random values
+template <xilefian::bheap_sift Sift>
+static auto pop_comparisons(const std::vector<int>& values) {
+    std::size_t count = 0;
+    xilefian::bheap<int, counting_less, std::vector<int>, 2, Sift> heap{values, counting_less{&count}};
+    count = 0;
+    while (!heap.empty()) {
+        heap.pop();
+    }
+    return count;
+}
+
+int main() {
+    using xilefian::bheap_sift;
+
+    run<2, bheap_sift::top_down>();
+    run<3, bheap_sift::top_down>();
+    run<4, bheap_sift::top_down>();
+    run<8, bheap_sift::top_down>();
+    run<2, bheap_sift::bottom_up>();
+    run<3, bheap_sift::bottom_up>();
+    run<4, bheap_sift::bottom_up>();
+    run<8, bheap_sift::bottom_up>();
+
+    // The moved value usually belongs near a leaf, so bottom-up saves most of the comparisons against it
+    std::mt19937 rng{74};
+    std::vector<int> values(10000);
+    for (auto& value : values) {
+        value = static_cast<int>(rng());
+    }
+    assert(pop_comparisons<bheap_sift::bottom_up>(values) * 4 < pop_comparisons<bheap_sift::top_down>(values) * 3);
+    return 0;
+}
@@ -0,0 +1,61 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <array>
+#include <cassert>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+
+// Batched lookups take keys straight from a vector, array or span, and match one lookup per key
+
+int main() {
+    std::mt19937 rng{58};
+
+    xilefian::btree<int> tree;
+    for (auto ii = 0; ii < 5000; ++ii) {
+        tree.emplace(static_cast<int>(rng() % 10000));
+    }
+    auto frozen = tree.freeze();
+
+    // More keys than one interleaved group, some above every value, of a different type than the values
+    std::vector<long> keys(100);
+    for (auto& key : keys) {
+        key = static_cast<long>(rng() % 10200);
+    }
+
+    std::vector<decltype(tree)::iterator> lower(keys.size());
+    std::vector<decltype(tree)::iterator> found(keys.size());
+    std::vector<decltype(frozen)::iterator> frozenLower(keys.size());
+    tree.lower_bound_batch(keys, lower);
+    tree.find_batch(keys, found);
+    frozen.lower_bound(keys, frozenLower);
+
+    for (std::size_t ii = 0; ii < keys.size(); ++ii) {
+        assert(lower[ii] == tree.lower_bound(keys[ii]));
+        assert(found[ii] == tree.find(keys[ii]));
+        assert(frozenLower[ii] == frozen.lower_bound(keys[ii]));
+    }
+
+    const std::array<int, 3> array{-1, 5000, 20000};
+    std::array<decltype(tree)::iterator, 3> arrayResults;
+    tree.lower_bound_batch(array, arrayResults);
+    tree.find_batch(std::span{array}, arrayResults);
+    for (std::size_t ii = 0; ii < array.size(); ++ii) {
+        assert(arrayResults[ii] == tree.find(array[ii]));
+    }
+
+    const int raw[] = {0, 9999};
+    std::array<decltype(frozen)::iterator, 2> rawResults;
+    frozen.lower_bound(raw, rawResults);
+    assert(rawResults[0] == frozen.begin() && rawResults[1] == frozen.lower_bound(9999));
+    return 0;
+}
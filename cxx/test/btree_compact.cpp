@@ -0,0 +1,81 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+
+// compact() on random trees checked against std::multiset: order and shape are kept,
+// values keep their addresses unless moveValues is set
+
+template <class Set>
+static void check(xilefian::btree<std::string>& tree, const Set& set) {
+    auto expected = set.begin();
+    tree.for_each([&](const std::string& value) {
+        assert(expected != set.end() && value == *expected);
+        ++expected;
+    });
+    assert(expected == set.end());
+
+    auto iter = tree.end();
+    for (auto reverse = set.rbegin(); reverse != set.rend(); ++reverse) {
+        --iter;
+        assert(*iter == *reverse);
+    }
+}
+
+static auto addresses(xilefian::btree<std::string>& tree) {
+    std::vector<const std::string*> result;
+    tree.for_each([&result](const std::string& value) {
+        result.push_back(&value);
+    });
+    return result;
+}
+
+int main() {
+    std::mt19937 rng{68};
+
+    for (auto n = 0; n < 2000; n += 1 + n / 2) {
+        xilefian::btree<std::string> tree;
+        std::multiset<std::string> set;
+
+        for (auto round = 0; round < 4; ++round) {
+            for (auto ii = 0; ii < n; ++ii) {
+                // Long enough to live on the heap, so a botched move shows up as a wrong or freed string
+                auto value = std::string(24, 'x') + std::to_string(rng() % 500);
+                tree.emplace(value);
+                set.insert(std::move(value));
+            }
+
+            const auto before = addresses(tree);
+            const auto histogram = tree.stats().depthHistogram;
+
+            const auto moveValues = round % 2 == 1;
+            tree.compact(moveValues);
+            check(tree, set);
+            assert(tree.stats().depthHistogram == histogram);
+
+            const auto after = addresses(tree);
+            for (std::size_t ii = 0; ii < after.size(); ++ii) {
+                assert((after[ii] == before[ii]) != moveValues);
+            }
+
+            // Appending through a fresh end() relies on the rightmost node being the new copy
+            auto value = std::string(25, 'z');
+            tree.emplace_hint(tree.end(), value);
+            set.insert(std::move(value));
+            check(tree, set);
+        }
+    }
+    return 0;
+}
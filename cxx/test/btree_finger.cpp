@@ -0,0 +1,72 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+
+#include <xilefian/btree.hpp>
+#include <xilefian/bvec.hpp>
+
+// Paths deeper than the inline capacity of bvec live on the heap, copying a finger copies that path
+int main() {
+    xilefian::bvec<> code;
+    for (auto ii = 0; ii < 1000; ++ii) {
+        code.push_back(ii % 3 == 0);
+    }
+    for (auto begin = 0; begin < 200; begin += 7) {
+        for (auto end = begin; end <= 1000; end += 61) {
+            const xilefian::bvec<> copy{code.cbegin() + begin, code.cbegin() + end};
+            assert(copy.size() == static_cast<std::size_t>(end - begin));
+            for (auto ii = begin; ii < end; ++ii) {
+                assert(copy[static_cast<std::size_t>(ii - begin)] == code[static_cast<std::size_t>(ii)]);
+            }
+
+            auto erased = code;
+            erased.erase(erased.cbegin() + begin, erased.cbegin() + end);
+            assert(erased.size() == code.size() - static_cast<std::size_t>(end - begin));
+            for (auto ii = 0; ii < static_cast<int>(erased.size()); ++ii) {
+                const auto from = ii < begin ? ii : ii + (end - begin);
+                assert(erased[static_cast<std::size_t>(ii)] == code[static_cast<std::size_t>(from)]);
+            }
+        }
+    }
+
+    // Sorted appends through an lvalue hint build a 3000 deep vine
+    xilefian::btree<int> tree;
+    auto hint = tree.end();
+    for (auto ii = 0; ii < 3000; ii += 2) {
+        hint = tree.emplace_hint(hint, ii);
+    }
+
+    auto finger = tree.begin();
+    for (auto ii = 0; ii < 1400; ++ii) {
+        ++finger;
+    }
+    assert(*finger == 2800);
+
+    for (auto key = 0; key < 3000; key += 97) {
+        auto found = tree.lower_bound(finger, key);
+        assert(found != tree.end() && *found == key + (key & 1));
+        assert((tree.find(finger, key) != tree.end()) == (key % 2 == 0));
+    }
+
+    for (auto key = 1; key < 3000; key += 50) {
+        auto placed = tree.emplace_hint(finger, key);
+        assert(*placed == key);
+    }
+
+    auto count = 0;
+    auto previous = -1;
+    tree.for_each([&](const int value) {
+        assert(value >= previous);
+        previous = value;
+        ++count;
+    });
+    assert(count == 1500 + 60);
+    return 0;
+}
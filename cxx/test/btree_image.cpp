@@ -0,0 +1,76 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <type_traits>
+
+#include <xilefian/btree.hpp>
+#include <xilefian/btree_image.hpp>
+
+using mapped_type = xilefian::mapped_btree<int>;
+
+// Images are mapped read-only, nothing reachable from a mapped_btree is writable
+static_assert(!std::is_assignable_v<decltype(*std::declval<mapped_type::iterator>()), int>);
+static_assert(!std::is_assignable_v<decltype(std::declval<const mapped_type&>().tree()[1]), int>);
+
+int main() {
+    constexpr auto path = "test_btree_image.bin";
+
+    xilefian::btree<int> tree;
+    for (auto ii = 0; ii < 500; ++ii) {
+        tree.emplace((ii * 31) % 500);
+    }
+    const auto saved = xilefian::save(tree, path);
+    assert(saved);
+
+    {
+        auto mapped = mapped_type::map(path);
+        assert(mapped && mapped->size() == 500);
+
+        auto expected = 0;
+        for (auto it = mapped->begin(); it != mapped->end(); ++it) {
+            assert(*it == expected++);
+        }
+        assert(*mapped->lower_bound(250) == 250);
+        assert(!mapped->contains(500));
+
+        assert(!xilefian::mapped_btree<long long>::map(path));
+    }
+
+    // A count past the end of the file, including one whose slot total wraps around, is rejected
+    for (const auto count : {std::uint64_t{501}, std::numeric_limits<std::uint64_t>::max(), std::numeric_limits<std::uint64_t>::max() / sizeof(int)}) {
+        {
+            std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+            file.seekp(static_cast<std::streamoff>(offsetof(xilefian::btree_image_header, count)));
+            file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        }
+        assert(!mapped_type::map(path));
+    }
+
+    // Truncated images are rejected, down to a header cut short
+    {
+        std::uint64_t count = 500;
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(static_cast<std::streamoff>(offsetof(xilefian::btree_image_header, count)));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    }
+    for (const auto length : {xilefian::btree_image_header::data_offset + 500 * sizeof(int), xilefian::btree_image_header::data_offset, std::size_t{16}}) {
+        std::filesystem::resize_file(path, length);
+        assert(!mapped_type::map(path));
+    }
+
+    std::remove(path);
+    return 0;
+}
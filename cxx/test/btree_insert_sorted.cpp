@@ -0,0 +1,72 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+
+// insert_sorted and insert_batch on empty and populated trees, checked against std::multiset
+
+template <class Set>
+static void check(xilefian::btree<int>& tree, const Set& set) {
+    auto expected = set.begin();
+    tree.for_each([&](const int value) {
+        assert(expected != set.end() && value == *expected);
+        ++expected;
+    });
+    assert(expected == set.end());
+}
+
+int main() {
+    std::mt19937 rng{70};
+
+    for (auto n = 0; n < 3000; n += 1 + n / 3) {
+        std::vector<int> values(static_cast<std::size_t>(n));
+        std::generate(values.begin(), values.end(), [&rng, n] {
+            return static_cast<int>(rng() % static_cast<unsigned>(n / 2 + 1)); // Plenty of duplicates
+        });
+
+        // A sorted range into an empty tree comes out balanced
+        std::vector<int> sorted = values;
+        std::sort(sorted.begin(), sorted.end());
+
+        xilefian::btree<int> tree;
+        std::multiset<int> set(sorted.begin(), sorted.end());
+        tree.insert_sorted(sorted.begin(), sorted.end());
+        check(tree, set);
+        assert(tree.stats().height == std::bit_width(sorted.size()));
+
+        // Into a populated tree, each value climbs from the previous one to its place between the existing values
+        std::vector<int> more(static_cast<std::size_t>(n / 2));
+        std::generate(more.begin(), more.end(), [&rng, n] {
+            return static_cast<int>(rng() % static_cast<unsigned>(n + 1)) - 5;
+        });
+        std::sort(more.begin(), more.end());
+        tree.insert_sorted(more.begin(), more.end());
+        set.insert(more.begin(), more.end());
+        check(tree, set);
+
+        // Unsorted batches are sorted first, into both an empty and the populated tree
+        xilefian::btree<int> batched;
+        batched.insert_batch(values.begin(), values.end());
+        check(batched, std::multiset<int>(values.begin(), values.end()));
+        assert(batched.stats().height == std::bit_width(values.size()));
+
+        std::shuffle(more.begin(), more.end(), rng);
+        tree.insert_batch(more.begin(), more.end());
+        set.insert(more.begin(), more.end());
+        check(tree, set);
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <compare>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include <xilefian/btree_map.hpp>
+
+// A btree_map must not be usable as a btree_multimap, whose emplace would add duplicate keys
+static_assert(!std::is_convertible_v<xilefian::btree_map<int, int>&, xilefian::btree_multimap<int, int>&>);
+
+int main() {
+    xilefian::btree_map<std::string, int> words;
+    words["b"] = 2;
+    words["a"] = 1;
+    const auto existing = words.try_emplace("a", 5);
+    assert(!existing.second);
+    assert(words.find("a")->second == 1);
+    const auto assigned = words.insert_or_assign("b", 3);
+    assert(!assigned.second);
+    const auto b = words["b"];
+    assert(b == 3);
+
+    // Keys with a .first member of their own
+    xilefian::btree_map<std::pair<int, int>, int> grid;
+    for (auto x = 0; x < 10; ++x) {
+        for (auto y = 9; y >= 0; --y) {
+            grid[{x, y}] = x * 10 + y;
+        }
+    }
+    const auto kept = grid.try_emplace({3, 4}, -1);
+    assert(!kept.second);
+    const auto added = grid.try_emplace({10, 0}, 100);
+    assert(added.second);
+    assert(grid.find(std::pair{7, 2})->second == 72);
+    assert(grid.find(std::pair{11, 0}) == grid.end());
+
+    auto expected = 0;
+    for (auto it = grid.begin(); it != grid.end(); ++it) {
+        assert(it->second == expected++);
+    }
+    assert(expected == 101);
+
+    xilefian::btree_map<std::pair<int, int>, int, std::compare_three_way> ordered;
+    ordered[{1, 2}] = 12;
+    ordered[{1, 1}] = 11;
+    assert(ordered.begin()->second == 11);
+    const auto duplicate = ordered.try_emplace({1, 2}, 0);
+    assert(!duplicate.second);
+
+    xilefian::btree_map<int, int> unique;
+    unique.emplace(1, 2);
+    auto again = unique.emplace(1, 3);
+    assert(!again.second && again.first->second == 2);
+    const auto range = unique.equal_range(1);
+    assert(range.first == unique.begin() && range.second == unique.end() && unique.contains(1));
+    return 0;
+}
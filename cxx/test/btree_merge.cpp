@@ -0,0 +1,42 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+
+#include <xilefian/btree.hpp>
+
+// Sorted inserts build a vine, merging one must not recurse per level
+int main() {
+    constexpr auto count = 1000000;
+
+    xilefian::btree<int> vine;
+    auto hint = vine.end();
+    for (auto ii = 0; ii < count; ++ii) {
+        hint = vine.emplace_hint(std::move(hint), 2 * ii);
+    }
+
+    xilefian::btree<int> tree;
+    for (auto ii = 1; ii < 2 * count; ii += 20000) {
+        tree.emplace(ii);
+    }
+
+    tree.merge(vine);
+    assert(vine.empty());
+
+    auto merged = 0;
+    auto previous = -1;
+    tree.for_each([&](const int value) {
+        assert(value > previous);
+        previous = value;
+        ++merged;
+    });
+    assert(merged == count + 100);
+    assert(*tree.lower_bound(2 * count - 3) == 2 * count - 2);
+    return 0;
+}
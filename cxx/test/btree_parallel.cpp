@@ -0,0 +1,82 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <atomic>
+#include <cassert>
+#include <execution>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <xilefian/btree_parallel.hpp>
+
+// Parallel for_each, transform_reduce, insert_batch and clear on random and degenerate trees, checked against std::multiset
+
+template <class Set>
+static void check(xilefian::btree<int>& tree, const Set& set, int range) {
+    // Every value is visited exactly as often as it is held
+    std::vector<std::atomic<int>> seen(static_cast<std::size_t>(range));
+    xilefian::for_each(std::execution::par, tree, [&seen](const int value) {
+        seen[static_cast<std::size_t>(value)].fetch_add(1, std::memory_order_relaxed);
+    });
+    for (auto value = 0; value < range; ++value) {
+        assert(seen[static_cast<std::size_t>(value)].load() == static_cast<int>(set.count(value)));
+    }
+
+    // Concatenation is associative but not commutative, so the fold must come out in sequence order
+    const auto concatenate = [](std::vector<int> lhs, const std::vector<int>& rhs) {
+        lhs.insert(lhs.end(), rhs.begin(), rhs.end());
+        return lhs;
+    };
+    const auto single = [](const int value) {
+        return std::vector<int>{value};
+    };
+    const std::vector<int> expected(set.begin(), set.end());
+    assert(xilefian::transform_reduce(std::execution::par, tree, std::vector<int>{}, concatenate, single) == expected);
+    assert(xilefian::transform_reduce(std::execution::seq, tree, std::vector<int>{}, concatenate, single) == expected);
+}
+
+int main() {
+    std::mt19937 rng{66};
+
+    for (auto n = 0; n < 5000; n += 1 + n) {
+        const auto range = n / 2 + 1;
+        for (auto vine = 0; vine < 2; ++vine) {
+            xilefian::btree<int> tree;
+            std::multiset<int> set;
+
+            // Ascending inserts build a vine, which detaches into few pieces
+            for (auto ii = 0; ii < n; ++ii) {
+                const auto value = vine ? ii % range : static_cast<int>(rng() % static_cast<unsigned>(range));
+                tree.emplace(value);
+                set.insert(value);
+            }
+            check(tree, set, range);
+
+            std::vector<int> batch(static_cast<std::size_t>(n / 3));
+            for (auto& value : batch) {
+                value = static_cast<int>(rng() % static_cast<unsigned>(range));
+            }
+            xilefian::insert_batch(std::execution::par, tree, batch.begin(), batch.end());
+            set.insert(batch.begin(), batch.end());
+            check(tree, set, range);
+
+            // Cleared trees hold nothing and can be filled again, leaks are left to the sanitizers
+            xilefian::clear(std::execution::par, tree);
+            set.clear();
+            assert(tree.empty());
+            check(tree, set, range);
+
+            tree.emplace(0);
+            set.insert(0);
+            check(tree, set, range);
+        }
+    }
+    return 0;
+}
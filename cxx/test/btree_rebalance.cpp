@@ -0,0 +1,79 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <bit>
+#include <cassert>
+#include <random>
+#include <set>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+
+// Day-Stout-Warren rebalance of random and degenerate trees, checked against std::multiset
+// Order and value addresses must survive, and the height must be minimal for the node count
+
+template <class Set>
+static void check(xilefian::btree<int>& tree, const Set& set) {
+    auto expected = set.begin();
+    tree.for_each([&](const int value) {
+        assert(expected != set.end() && value == *expected);
+        ++expected;
+    });
+    assert(expected == set.end());
+
+    auto iter = tree.end();
+    for (auto reverse = set.rbegin(); reverse != set.rend(); ++reverse) {
+        --iter;
+        assert(*iter == *reverse);
+    }
+}
+
+int main() {
+    std::mt19937 rng{59};
+
+    for (auto n = 0; n < 300; n += 1 + n / 8) {
+        for (auto shape = 0; shape < 3; ++shape) {
+            xilefian::btree<int> tree;
+            std::multiset<int> set;
+            for (auto ii = 0; ii < n; ++ii) {
+                // Ascending and descending inserts build vines down either side, the rest is random with duplicates
+                const auto value = shape == 0 ? ii : shape == 1 ? n - ii : static_cast<int>(rng() % 100);
+                tree.emplace(value);
+                set.insert(value);
+            }
+
+            std::vector<const int*> addresses;
+            tree.for_each([&addresses](const int& value) {
+                addresses.push_back(&value);
+            });
+
+            tree.rebalance();
+            check(tree, set);
+
+            const auto stats = tree.stats();
+            assert(stats.nodes == static_cast<std::size_t>(n));
+            assert(stats.height == std::bit_width(static_cast<std::size_t>(n)));
+
+            auto address = addresses.begin();
+            tree.for_each([&address](const int& value) {
+                assert(&value == *address++);
+            });
+
+            // The rebalanced tree is an ordinary tree again
+            for (auto ii = 0; ii < 50; ++ii) {
+                const auto value = static_cast<int>(rng() % 400) - 50;
+                tree.emplace(value);
+                set.insert(value);
+                assert(tree.find(value) != tree.end());
+            }
+            check(tree, set);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,90 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <set>
+
+#include <xilefian/btree.hpp>
+
+// Random operations in the self-adjusting modes checked against std::multiset
+// Every find or emplace restructures the tree, so iterators returned by it must carry a fresh path code,
+// and end() or a hint taken before the restructure must be taken again before use
+
+static void run(xilefian::btree_access access) {
+    std::mt19937 rng{65};
+
+    xilefian::btree<int> tree;
+    tree.set_access(access);
+    std::multiset<int> set;
+
+    for (auto ii = 0; ii < 5000; ++ii) {
+        const auto key = static_cast<int>(rng() % 3000);
+        switch (rng() % 4) {
+        case 0: {
+            auto placed = tree.emplace(key);
+            assert(*placed == key);
+            set.insert(key);
+            break;
+        }
+        case 1: {
+            // Refreshed end() after the previous restructure, appending at the maximum must stay O(1) and ordered
+            const auto value = set.empty() ? key : *set.rbegin() + static_cast<int>(rng() % 3);
+            auto placed = tree.emplace_hint(tree.end(), value);
+            assert(*placed == value);
+            set.insert(value);
+            break;
+        }
+        default: {
+            auto found = tree.find(key);
+            assert((found != tree.end()) == set.contains(key));
+            if (found == tree.end()) {
+                break;
+            }
+
+            // The returned path code must match the restructured tree, so stepping from it follows key order
+            auto expected = set.find(key);
+            auto forward = found;
+            for (auto step = 0; step < 3 && std::next(expected) != set.end(); ++step) {
+                ++forward;
+                ++expected;
+                assert(*forward == *expected);
+            }
+
+            // It is also a valid hint, which climbs through that code
+            const auto value = key + static_cast<int>(rng() % 40) - 20;
+            auto placed = tree.emplace_hint(std::move(found), value);
+            assert(*placed == value);
+            set.insert(value);
+        }
+        }
+    }
+
+    auto expected = set.begin();
+    tree.for_each([&](const int value) {
+        assert(expected != set.end() && value == *expected);
+        ++expected;
+    });
+    assert(expected == set.end());
+
+    // Walking back from end() taken after the last restructure visits everything in reverse
+    auto iter = tree.end();
+    for (auto reverse = set.rbegin(); reverse != set.rend(); ++reverse) {
+        --iter;
+        assert(*iter == *reverse);
+    }
+    assert(iter == tree.begin());
+}
+
+int main() {
+    run(xilefian::btree_access::splay);
+    run(xilefian::btree_access::semisplay);
+    return 0;
+}
@@ -0,0 +1,82 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#define XILEFIAN_BTREE_STATS
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+
+// emplaceComparisons matches the comparator calls of every emplace path, hints and unique inserts included
+
+static std::uint64_t calls = 0;
+
+struct counting_less {
+    bool operator()(const int lhs, const int rhs) const noexcept {
+        ++calls;
+        return lhs < rhs;
+    }
+};
+
+struct counting_three_way {
+    std::strong_ordering operator()(const int lhs, const int rhs) const noexcept {
+        ++calls;
+        return lhs <=> rhs;
+    }
+};
+
+template <class Compare>
+static void run() {
+    using tree_type = xilefian::btree<int, Compare>;
+
+    std::mt19937 rng{67};
+    tree_type tree;
+    tree_type::reset_counters();
+    calls = 0;
+
+    auto hint = tree.end();
+    for (auto ii = 0; ii < 5000; ++ii) {
+        const auto value = static_cast<int>(rng() % 2000);
+        switch (rng() % 5) {
+        case 0:
+            tree.emplace(value);
+            break;
+        case 1:
+            tree.emplace_unique(value);
+            break;
+        case 2:
+            hint = tree.emplace_hint(tree.end(), value); // Often below the maximum, so the hint climbs
+            break;
+        case 3:
+            hint = tree.emplace_hint(std::move(hint), value);
+            break;
+        default: {
+            std::vector<int> sorted(rng() % 8);
+            for (auto& item : sorted) {
+                item = static_cast<int>(rng() % 2000);
+            }
+            std::sort(sorted.begin(), sorted.end());
+            tree.insert_sorted(sorted.begin(), sorted.end()); // Emplaces through hints
+            hint = tree.end();
+        }
+        }
+        assert(tree.stats().emplaceComparisons == calls);
+    }
+}
+
+int main() {
+    run<counting_less>();
+    run<counting_three_way>();
+    return 0;
+}
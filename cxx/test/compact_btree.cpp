@@ -0,0 +1,89 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <iterator>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <xilefian/compact_btree.hpp>
+
+// Random emplace and emplace_hint checked against std::multiset, including the placement of equal keys
+
+using value_type = std::pair<int, int>; // Key and insertion order
+
+struct key_less {
+    constexpr bool operator()(const value_type& lhs, const value_type& rhs) const noexcept {
+        return lhs.first < rhs.first;
+    }
+};
+
+int main() {
+    std::mt19937 rng{61};
+
+    xilefian::compact_btree<value_type, key_less> tree;
+    std::multiset<value_type, key_less> set;
+
+    // Iterators name indices, so they must survive the arena growing underneath them
+    std::vector<std::pair<decltype(tree)::iterator, value_type>> held;
+
+    for (auto ii = 0; ii < 20000; ++ii) {
+        const auto key = static_cast<int>(rng() % 2000);
+
+        decltype(tree)::iterator iter;
+        switch (rng() % 4) {
+        case 0:
+            iter = tree.emplace_hint(tree.end(), key, ii); // Often not the maximum, so it must fall back to descent
+            break;
+        case 1: {
+            auto last = tree.end();
+            iter = tree.emplace_hint(tree.empty() ? last : --last, key + 2000, ii); // Appends past the maximum
+            break;
+        }
+        default:
+            iter = tree.emplace(key, ii);
+        }
+        assert(iter != tree.end() && iter->second == ii);
+        set.emplace(iter->first, ii);
+
+        if (ii % 1000 == 0) {
+            held.emplace_back(iter, *iter);
+        }
+
+        const auto probe = static_cast<int>(rng() % 4000);
+        const auto lower = tree.lower_bound(value_type{probe, 0});
+        const auto expectedLower = set.lower_bound(value_type{probe, 0});
+        assert((lower == tree.end()) == (expectedLower == set.end()));
+        assert(lower == tree.end() || *lower == *expectedLower);
+
+        const auto upper = tree.upper_bound(value_type{probe, 0});
+        const auto expectedUpper = set.upper_bound(value_type{probe, 0});
+        assert((upper == tree.end()) == (expectedUpper == set.end()));
+        assert(upper == tree.end() || *upper == *expectedUpper);
+
+        assert(tree.contains(value_type{probe, 0}) == set.contains(value_type{probe, 0}));
+    }
+
+    // Equal keys keep insertion order, as in std::multiset
+    assert(tree.size() == set.size());
+    assert(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    assert(std::equal(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin()), set.rbegin(), set.rend()));
+
+    for (const auto& [iter, value] : held) {
+        assert(*iter == value);
+    }
+
+    assert(decltype(tree)::max_size() == decltype(tree)::null_index);
+    tree.clear();
+    assert(tree.empty() && tree.begin() == tree.end());
+    return 0;
+}
@@ -0,0 +1,49 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <thread>
+#include <vector>
+
+#include <xilefian/concurrent_btree.hpp>
+
+int main() {
+    constexpr auto threads = 4;
+    constexpr auto perThread = 20000;
+
+    xilefian::concurrent_btree<int> tree;
+
+    std::vector<std::thread> workers;
+    for (auto t = 0; t < threads; ++t) {
+        workers.emplace_back([&tree, t] {
+            for (auto ii = 0; ii < perThread; ++ii) {
+                const auto value = ((ii * 7919) % perThread) * threads + t; // Scrambled, sorted inserts would build a vine
+                tree.emplace(value);
+                assert(tree.contains(value));
+                if (value % 3 == 0) {
+                    const auto erased = tree.erase(value);
+                    assert(erased);
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    auto count = 0;
+    auto previous = -1;
+    tree.for_each([&](const int value) {
+        assert(value > previous && value % 3 != 0);
+        previous = value;
+        ++count;
+    });
+    assert(count == threads * perThread - (threads * perThread + 2) / 3);
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include <xilefian/btree.hpp>
+#include <xilefian/frozen_btree.hpp>
+
+using frozen_type = xilefian::frozen_btree<int>;
+
+// Snapshots are read-only through every accessor
+static_assert(std::is_same_v<decltype(std::declval<const frozen_type&>()[1]), const int&>);
+static_assert(std::is_same_v<decltype(std::declval<const frozen_type&>().data()), const int*>);
+static_assert(std::is_same_v<decltype(*std::declval<frozen_type::iterator>()), const int&>);
+static_assert(std::is_same_v<decltype(std::declval<frozen_type::iterator>().operator->()), const int*>);
+
+// Owned storage starts on a cache line, so the prefetched descendants of a slot do not straddle two lines
+template <typename T>
+static void check_alignment() {
+    for (std::size_t n = 1; n < 40; ++n) {
+        const std::vector<T> values(n);
+        const xilefian::frozen_btree<T> frozen(values.begin(), values.end());
+        assert(reinterpret_cast<std::uintptr_t>(frozen.data()) % 64 == 0);
+    }
+}
+
+struct three_ints {
+    int values[3];
+
+    constexpr bool operator<(const three_ints& rhs) const noexcept {
+        return values[0] < rhs.values[0];
+    }
+};
+
+int main() {
+    check_alignment<char>();
+    check_alignment<int>();
+    check_alignment<three_ints>();
+    check_alignment<std::array<double, 20>>();
+
+    xilefian::btree<int> tree;
+    for (auto ii = 0; ii < 1000; ++ii) {
+        tree.emplace((ii * 7919) % 1000);
+    }
+
+    const auto frozen = tree.freeze();
+    assert(frozen.size() == 1000);
+
+    auto expected = 0;
+    for (auto it = frozen.begin(); it != frozen.end(); ++it) {
+        assert(*it == expected++);
+    }
+
+    for (auto key = -1; key <= 1000; ++key) {
+        const auto it = frozen.lower_bound(key);
+        if (key >= 999) {
+            assert(key == 999 ? *it == 999 : it == frozen.end());
+        } else {
+            assert(*it == (key < 0 ? 0 : key));
+        }
+        assert(frozen.contains(key) == (key >= 0 && key < 1000));
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <cstddef>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <xilefian/interval_btree.hpp>
+
+// Random intervals, overlap queries checked against a filtered std::multiset ordered by lower endpoint
+
+using interval = std::pair<int, int>;
+
+struct lower_less {
+    constexpr bool operator()(const interval& lhs, const interval& rhs) const noexcept {
+        return lhs.first < rhs.first;
+    }
+};
+
+int main() {
+    std::mt19937 rng{56};
+
+    xilefian::interval_btree<interval> tree;
+    std::multiset<interval, lower_less> set;
+
+    for (auto round = 0; round < 2; ++round) {
+        for (auto ii = 0; ii < 3000; ++ii) {
+            const auto lower = static_cast<int>(rng() % 10000);
+            const auto length = static_cast<int>(rng() % 8 ? rng() % 50 : rng() % 2000); // Mostly short, some long enough to span many others
+            const auto& stored = tree.emplace(lower, lower + length);
+            assert(stored == interval(lower, lower + length));
+            set.emplace(lower, lower + length);
+
+            const auto queryLower = static_cast<int>(rng() % 10500) - 250;
+            const auto queryUpper = queryLower + static_cast<int>(rng() % 300);
+
+            // Equal lower endpoints are visited in insertion order, as std::multiset holds them
+            std::vector<interval> expected;
+            for (const auto& value : set) {
+                if (value.first < queryUpper && queryLower < value.second) {
+                    expected.push_back(value);
+                }
+            }
+
+            std::vector<interval> found;
+            tree.for_each_overlap(queryLower, queryUpper, [&found](const interval& value) {
+                found.push_back(value);
+            });
+            assert(found == expected);
+            assert(tree.count_overlaps(queryLower, queryUpper) == expected.size());
+        }
+
+        // A one-wide query stabs the intervals containing that point
+        auto stabbed = std::size_t{};
+        for (const auto& value : set) {
+            stabbed += value.first <= 5000 && 5000 < value.second;
+        }
+        assert(tree.count_overlaps(5000, 5001) == stabbed);
+
+        tree.clear();
+        set.clear();
+        assert(tree.empty() && tree.count_overlaps(-1, 20000) == 0);
+    }
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <xilefian/persistent_btree.hpp>
+
+// Snapshot isolation, reclamation of unshared nodes, and one writer racing snapshot readers (run under -fsanitize=thread)
+
+static std::atomic<std::ptrdiff_t> live{};
+
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() noexcept = default;
+
+    template <typename U>
+    counting_allocator(const counting_allocator<U>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        live.fetch_add(1, std::memory_order_relaxed);
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        live.fetch_sub(1, std::memory_order_relaxed);
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    template <typename U>
+    bool operator==(const counting_allocator<U>&) const noexcept {
+        return true;
+    }
+};
+
+using tree_type = xilefian::persistent_btree<int, std::less<int>, counting_allocator<int>>;
+
+static constexpr int scrambled(int ii, int n) {
+    return (ii * 7919) % n; // Sorted inserts would build a vine
+}
+
+// Values of the first count inserts, in order
+static std::vector<int> version(int count, int n) {
+    std::vector<int> values;
+    for (auto ii = 0; ii < count; ++ii) {
+        values.push_back(scrambled(ii, n));
+    }
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+static void snapshots() {
+    constexpr auto n = 1000;
+    constexpr auto every = 100;
+
+    tree_type tree;
+    std::vector<tree_type::view> views;
+    views.push_back(tree.snapshot());
+    for (auto ii = 0; ii < n; ++ii) {
+        tree.insert(scrambled(ii, n));
+        if ((ii + 1) % every == 0) {
+            views.push_back(tree.snapshot());
+        }
+    }
+
+    // Every view still iterates exactly the values inserted before it was taken
+    assert(views.front().empty());
+    for (std::size_t vv = 0; vv < views.size(); ++vv) {
+        const auto expected = version(static_cast<int>(vv) * every, n);
+        assert(std::equal(views[vv].begin(), views[vv].end(), expected.begin(), expected.end()));
+        for (const auto value : expected) {
+            assert(views[vv].contains(value));
+        }
+        if (vv + 1 < views.size()) {
+            assert(!views[vv].contains(scrambled(static_cast<int>(vv) * every, n)));
+        }
+    }
+}
+
+static void reclamation() {
+    constexpr auto n = 1000;
+    {
+        tree_type tree;
+        for (auto ii = 0; ii < n / 2; ++ii) {
+            tree.insert(scrambled(ii, n));
+        }
+
+        // Superseded paths are freed as soon as no version shares them, leaving one node per value
+        assert(live.load() == n / 2);
+
+        {
+            const auto view = tree.snapshot();
+            for (auto ii = n / 2; ii < n; ++ii) {
+                tree.insert(scrambled(ii, n));
+            }
+            assert(live.load() > n); // The held version keeps its copied paths alive
+        }
+        assert(live.load() == n);
+
+        // A copied view shares the version rather than the nodes
+        auto view = tree.snapshot();
+        {
+            const auto copy = view;
+            view = tree.snapshot();
+        }
+        assert(live.load() == n);
+    }
+    assert(live.load() == 0);
+}
+
+static void concurrent() {
+    constexpr auto n = 20000;
+    constexpr auto readers = 3;
+
+    tree_type tree;
+    std::atomic<bool> done{};
+
+    std::vector<std::thread> threads;
+    for (auto t = 0; t < readers; ++t) {
+        threads.emplace_back([&tree, &done] {
+            std::size_t previous = 0;
+            while (!done.load(std::memory_order_acquire)) {
+                const auto view = tree.snapshot();
+
+                // A version holds the first count inserts, sorted, and never fewer than an earlier one
+                std::vector<int> values(view.begin(), view.end());
+                assert(std::is_sorted(values.begin(), values.end()));
+                assert(values.size() >= previous);
+                for (std::size_t ii = 0; ii < values.size(); ++ii) {
+                    assert(view.contains(scrambled(static_cast<int>(ii), n)));
+                }
+                previous = values.size();
+            }
+        });
+    }
+
+    for (auto ii = 0; ii < n; ++ii) {
+        tree.insert(scrambled(ii, n));
+    }
+    done.store(true, std::memory_order_release);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    const auto view = tree.snapshot();
+    const auto expected = version(n, n);
+    assert(std::equal(view.begin(), view.end(), expected.begin(), expected.end()));
+}
+
+int main() {
+    snapshots();
+    reclamation();
+    concurrent();
+    assert(live.load() == 0);
+    return 0;
+}
@@ -0,0 +1,46 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include <xilefian/radix_heap.hpp>
+
+using heap_type = xilefian::radix_heap<std::int32_t, int>;
+
+// front() may redistribute buckets, so it is not offered on a const heap
+template <class Heap>
+concept const_front = requires(const Heap& heap) { heap.front(); };
+static_assert(!const_front<heap_type>);
+
+int main() {
+    heap_type heap;
+    heap.push({-5, 0});
+    heap.push({100, 1});
+    heap.push({-5, 2});
+    heap.emplace(7, 3);
+
+    assert(heap.front().first == -5);
+    heap.pop();
+    assert(heap.front().first == -5);
+    heap.pop();
+
+    // Pushing below the remaining minimum but not below the last seen key is allowed
+    heap.push({-5, 4});
+    heap.push({0, 5});
+
+    const std::int32_t expected[] = {-5, 0, 7, 100};
+    for (const auto key : expected) {
+        assert(heap.front().first == key);
+        heap.pop();
+    }
+    assert(heap.empty() && heap.size() == 0);
+    return 0;
+}
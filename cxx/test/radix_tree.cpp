@@ -0,0 +1,118 @@
+/*
+===============================================================================
+
+ Copyright (C) 2024 Felix Jones
+ For conditions of distribution and use, see copyright notice in LICENSE
+
+===============================================================================
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+
+#include <xilefian/radix_tree.hpp>
+
+// Random inserts, erases and lookups checked against std::set after every operation
+
+template <class Tree, class Set>
+static void check_order(Tree& tree, const Set& set) {
+    assert(tree.size() == set.size());
+    assert(std::equal(tree.begin(), tree.end(), set.begin(), set.end()));
+    assert(std::equal(std::make_reverse_iterator(tree.end()), std::make_reverse_iterator(tree.begin()), set.rbegin(), set.rend()));
+}
+
+template <class Tree, class Set, typename Key>
+static void check_lookup(Tree& tree, const Set& set, const Key& key) {
+    const auto lower = tree.lower_bound(key);
+    const auto expectedLower = set.lower_bound(key);
+    assert((lower == tree.end()) == (expectedLower == set.end()));
+    assert(lower == tree.end() || *lower == *expectedLower);
+
+    const auto upper = tree.upper_bound(key);
+    const auto expectedUpper = set.upper_bound(key);
+    assert((upper == tree.end()) == (expectedUpper == set.end()));
+    assert(upper == tree.end() || *upper == *expectedUpper);
+
+    const auto found = tree.find(key);
+    assert((found != tree.end()) == set.contains(key));
+    assert(found == tree.end() || *found == key);
+}
+
+template <typename Key, class Generate>
+static void run(std::mt19937& rng, Generate generate, int operations) {
+    xilefian::radix_tree<Key> tree;
+    std::set<Key> set;
+
+    for (auto ii = 0; ii < operations; ++ii) {
+        const auto key = generate();
+        switch (rng() % 8) {
+        case 0: case 1: case 2: case 3: {
+            const auto [iter, inserted] = tree.emplace(key);
+            assert(inserted == set.insert(key).second);
+            assert(*iter == key);
+            break;
+        }
+        case 4: {
+            const auto erased = tree.erase(key);
+            assert(erased == set.erase(key));
+            break;
+        }
+        case 5: {
+            auto iter = tree.lower_bound(key);
+            const auto expected = set.lower_bound(key);
+            if (iter != tree.end()) {
+                const auto next = tree.erase(iter);
+                const auto expectedNext = set.erase(expected);
+                assert((next == tree.end()) == (expectedNext == set.end()));
+                assert(next == tree.end() || *next == *expectedNext);
+            }
+            break;
+        }
+        default:
+            check_lookup(tree, set, key);
+        }
+        check_order(tree, set);
+    }
+
+    // Erasing everything must shrink and collapse nodes back to an empty tree
+    while (!set.empty()) {
+        const auto key = *std::next(set.begin(), static_cast<std::ptrdiff_t>(rng() % set.size()));
+        const auto erased = tree.erase(key);
+        assert(erased == 1);
+        set.erase(key);
+        check_lookup(tree, set, key);
+        check_order(tree, set);
+    }
+    assert(tree.empty() && tree.begin() == tree.end());
+}
+
+int main() {
+    std::mt19937 rng{1234};
+
+    // Short strings over a tiny alphabet are often prefixes of one another, and include embedded '\0'
+    run<std::string>(rng, [&rng] {
+        static constexpr char alphabet[] = {'a', 'b', '\0', '\xff'};
+        std::string key(rng() % 6, 'a');
+        std::generate(key.begin(), key.end(), [&rng] { return alphabet[rng() % 4]; });
+        return key;
+    }, 20000);
+
+    // Long shared stems exceed the inline prefix, so prefix bytes are read back from leaves when splitting and merging
+    run<std::string>(rng, [&rng] {
+        std::string key(rng() % 2 ? "shared-stem-longer-than-eight-" : "shared-stem-");
+        key.append(rng() % 3, static_cast<char>('a' + rng() % 3));
+        return key;
+    }, 5000);
+
+    // Dense low bytes grow nodes up to node256 and shrink them again, sparse values exercise path compression
+    run<std::int64_t>(rng, [&rng] {
+        return rng() % 4 ? static_cast<std::int64_t>(rng() % 600) - 300 : static_cast<std::int64_t>(rng()) << (rng() % 32);
+    }, 40000);
+
+    return 0;
+}